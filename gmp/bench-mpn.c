@@ -0,0 +1,251 @@
+/* Benchmark for the mpn kernels used by printf, strtod and strtold:
+   mpn_mul_1, mpn_addmul_1, mpn_add_n, mpn_lshift and mpn_divmod_1.
+   The versions in the library, which are the assembler ones on the
+   68020 and later and the ColdFire, are timed against copies of the
+   C loops compiled into this program, for operands from 1 to 64
+   limbs.  The results of both are compared first.
+
+   Usage: bench-mpn [-t ticks]
+
+   -t is the least number of clock ticks spent on each size and
+   function (default CLOCKS_PER_SEC / 8).  */
+
+/* gmp-impl.h first, it wants to define alloca itself */
+#include "gmp.h"
+#include "gmp-impl.h"
+#include "longlong.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The loops of the C versions in mpn-*.c, with umul_ppmm and
+   udiv_qrnnd from longlong.h as they are there.  */
+
+static mp_limb_t
+c_mul_1 (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_size_t s1_size,
+	 mp_limb_t s2_limb)
+{
+  mp_limb_t cy_limb = 0, prod_high, prod_low;
+  mp_size_t j;
+
+  for (j = 0; j < s1_size; j++)
+    {
+      umul_ppmm (prod_high, prod_low, s1_ptr[j], s2_limb);
+      prod_low += cy_limb;
+      cy_limb = (prod_low < cy_limb) + prod_high;
+      res_ptr[j] = prod_low;
+    }
+  return cy_limb;
+}
+
+static mp_limb_t
+c_addmul_1 (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_size_t s1_size,
+	    mp_limb_t s2_limb)
+{
+  mp_limb_t cy_limb = 0, prod_high, prod_low, x;
+  mp_size_t j;
+
+  for (j = 0; j < s1_size; j++)
+    {
+      umul_ppmm (prod_high, prod_low, s1_ptr[j], s2_limb);
+      prod_low += cy_limb;
+      cy_limb = (prod_low < cy_limb) + prod_high;
+      x = res_ptr[j];
+      prod_low = x + prod_low;
+      cy_limb += (prod_low < x);
+      res_ptr[j] = prod_low;
+    }
+  return cy_limb;
+}
+
+static mp_limb_t
+c_add_n (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_srcptr s2_ptr, mp_size_t size)
+{
+  mp_limb_t x, y, cy = 0;
+  mp_size_t j;
+
+  for (j = 0; j < size; j++)
+    {
+      y = s2_ptr[j];
+      x = s1_ptr[j];
+      y += cy;
+      cy = (y < cy);
+      y = x + y;
+      cy = (y < x) + cy;
+      res_ptr[j] = y;
+    }
+  return cy;
+}
+
+static mp_limb_t
+c_lshift (mp_ptr wp, mp_srcptr up, mp_size_t usize, unsigned int cnt)
+{
+  mp_limb_t high_limb, low_limb, retval;
+  unsigned int sh_2 = BITS_PER_MP_LIMB - cnt;
+  mp_size_t i = usize - 1;
+
+  low_limb = up[i];
+  retval = low_limb >> sh_2;
+  high_limb = low_limb;
+  while (--i >= 0)
+    {
+      low_limb = up[i];
+      wp[i + 1] = (high_limb << cnt) | (low_limb >> sh_2);
+      high_limb = low_limb;
+    }
+  wp[0] = high_limb << cnt;
+  return retval;
+}
+
+static mp_limb_t
+c_divmod_1 (mp_ptr quot_ptr, mp_srcptr dividend_ptr,
+	    mp_size_t dividend_size, mp_limb_t divisor_limb)
+{
+  mp_limb_t n1, n0, r = 0;
+  mp_size_t i;
+  int norm;
+
+  /* a divisor with the top bit clear, so normalize as the C version
+     does where udiv_qrnnd needs it */
+  count_leading_zeros (norm, divisor_limb);
+  if (UDIV_NEEDS_NORMALIZATION && norm != 0)
+    {
+      divisor_limb <<= norm;
+      n1 = dividend_ptr[dividend_size - 1];
+      r = n1 >> (BITS_PER_MP_LIMB - norm);
+      for (i = dividend_size - 2; i >= 0; i--)
+	{
+	  n0 = dividend_ptr[i];
+	  udiv_qrnnd (quot_ptr[i + 1], r, r,
+		      (n1 << norm) | (n0 >> (BITS_PER_MP_LIMB - norm)),
+		      divisor_limb);
+	  n1 = n0;
+	}
+      udiv_qrnnd (quot_ptr[0], r, r, n1 << norm, divisor_limb);
+      return r >> norm;
+    }
+  for (i = dividend_size - 1; i >= 0; i--)
+    udiv_qrnnd (quot_ptr[i], r, r, dividend_ptr[i], divisor_limb);
+  return r;
+}
+
+#define MAXLIMBS 64
+
+static mp_limb_t s1[MAXLIMBS], s2[MAXLIMBS], res[MAXLIMBS], res2[MAXLIMBS];
+static clock_t ticks = CLOCKS_PER_SEC / 8;
+
+enum { MUL_1, ADDMUL_1, ADD_N, LSHIFT, DIVMOD_1 };
+static const char *const names[] =
+  { "mul_1", "addmul_1", "add_n", "lshift", "divmod_1" };
+
+/* the same pseudo random numbers everywhere */
+static unsigned long seed = 1;
+
+static mp_limb_t
+rnd (void)
+{
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  return (seed >> 8) ^ (seed << 16);
+}
+
+/* with lib != 0 the library version, else the C one */
+static mp_limb_t
+run (int what, int lib, mp_ptr r, mp_size_t n)
+{
+  switch (what)
+    {
+    case MUL_1:
+      return lib ? __mpn_mul_1 (r, s1, n, s2[0]) : c_mul_1 (r, s1, n, s2[0]);
+    case ADDMUL_1:
+      return (lib ? __mpn_addmul_1 (r, s1, n, s2[0])
+	      : c_addmul_1 (r, s1, n, s2[0]));
+    case ADD_N:
+      return lib ? __mpn_add_n (r, s1, s2, n) : c_add_n (r, s1, s2, n);
+    case LSHIFT:
+      return lib ? __mpn_lshift (r, s1, n, 13) : c_lshift (r, s1, n, 13);
+    default:
+      return (lib ? __mpn_divmod_1 (r, s1, n, 1000000000)
+	      : c_divmod_1 (r, s1, n, 1000000000));
+    }
+}
+
+/* limbs per second */
+static double
+rate (int what, int lib, mp_size_t n)
+{
+  unsigned long rounds = 1, i;
+  clock_t start, used;
+
+  for (;;)
+    {
+      start = clock ();
+      for (i = 0; i < rounds; i++)
+	run (what, lib, res, n);
+      used = clock () - start;
+      if (used >= ticks)
+	break;
+      if (used == 0)
+	rounds *= 8;
+      else
+	rounds = rounds * (ticks + used - 1) / used + 1;
+    }
+  return (double) n * rounds * CLOCKS_PER_SEC / used;
+}
+
+static int
+check (int what)
+{
+  mp_size_t n, i;
+  mp_limb_t cy, cy2;
+  int round;
+
+  for (round = 0; round < 16; round++)
+    for (n = 1; n <= MAXLIMBS; n++)
+      {
+	for (i = 0; i < MAXLIMBS; i++)
+	  {
+	    s1[i] = round & 1 ? ~(mp_limb_t) 0 : rnd ();
+	    s2[i] = round & 2 ? ~(mp_limb_t) 0 : rnd ();
+	    res[i] = res2[i] = rnd ();
+	  }
+	cy = run (what, 1, res, n);
+	cy2 = run (what, 0, res2, n);
+	if (cy != cy2 || memcmp (res, res2, sizeof res) != 0)
+	  {
+	    printf ("mpn_%s is broken for %ld limbs\n", names[what], (long) n);
+	    return 1;
+	  }
+      }
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  mp_size_t n;
+  int what, i;
+  double lib, c;
+
+  for (i = 1; i + 1 < argc; i += 2)
+    if (strcmp (argv[i], "-t") == 0)
+      ticks = strtol (argv[i + 1], NULL, 0);
+
+  for (what = MUL_1; what <= DIVMOD_1; what++)
+    if (check (what))
+      return 1;
+
+  printf ("%-8s %6s %12s %12s %6s\n", "", "limbs", "lib limbs/s",
+	  "C limbs/s", "gain");
+  for (what = MUL_1; what <= DIVMOD_1; what++)
+    for (n = 1; n <= MAXLIMBS; n *= 2)
+      {
+	lib = rate (what, 1, n);
+	c = rate (what, 0, n);
+	printf ("%-8s %6ld %12.0f %12.0f %5.2fx\n", names[what], (long) n,
+		lib, c, lib / c);
+      }
+
+  return 0;
+}
@@ -21,6 +21,10 @@ along with the GNU MP Library; if not, see
 #include <features.h>
 #include "gmp.h"
 #include "gmp-impl.h"
+#include "mpn-asm.h"
+
+/* The 68020 and later and the ColdFire use m68k-add_n.S.  */
+#ifndef MPN_ASM_KERNELS
 
 mp_limb_t
 #if __STDC__
@@ -60,3 +64,5 @@ mpn_add_n (res_ptr, s1_ptr, s2_ptr, size)
 
   return cy;
 }
+
+#endif /* MPN_ASM_KERNELS */
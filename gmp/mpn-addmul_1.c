@@ -25,6 +25,10 @@ along with the GNU MP Library; if not, see
 #include "gmp.h"
 #include "gmp-impl.h"
 #include "longlong.h"
+#include "mpn-asm.h"
+
+/* The 68020 and later and the ColdFire use m68k-addmul_1.S.  */
+#ifndef MPN_ASM_KERNELS
 
 mp_limb_t
 mpn_addmul_1 (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_size_t s1_size, mp_limb_t s2_limb)
@@ -59,3 +63,5 @@ mpn_addmul_1 (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_size_t s1_size, mp_limb_t s2_
 
   return cy_limb;
 }
+
+#endif /* MPN_ASM_KERNELS */
@@ -0,0 +1,64 @@
+/*  mpn-asm.h -- MiNTLib.
+
+    Selects the assembler versions of the mpn kernels.
+
+    This file is part of the MiNTLib project, and may only be used
+    modified and distributed under the terms of the MiNTLib project
+    license, COPYMINT.  By continuing to use, modify, or distribute
+    this file you indicate that you have read the license and
+    understand and accept it fully.
+*/
+
+#ifndef _MPN_ASM_H
+#define _MPN_ASM_H 1
+
+/* mpn_mul_1, mpn_addmul_1, mpn_add_n and mpn_lshift come from the
+   m68k-*.S files when MPN_ASM_KERNELS is defined, and mpn_divmod_1
+   when MPN_ASM_DIVMOD_1 is; the C versions then compile to nothing.
+   The assembler loops keep the carry in the X flag, which C cannot.
+   The 68020 to 68040 multiply 32 by 32 bits into 64 and divide 64 by
+   32 bits in one instruction.  The ColdFire only has the 16 bit
+   multiply and no long divide, so it multiplies with UMUL_W below and
+   keeps the C mpn_divmod_1.  The 68060 traps on both long forms;
+   mpn_mul_1 and mpn_addmul_1 switch to UMUL_W when __libc_cpu says
+   that it is one, and mpn_divmod_1 leaves its divide to the 68060
+   support package like the C code from longlong.h does.  The 68000
+   keeps everything in C, as do the fastcall flavours.  */
+#ifndef __FASTCALL__
+# if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__) || defined(__mcoldfire__)
+#  define MPN_ASM_KERNELS 1
+#  ifndef __mcoldfire__
+#   define MPN_ASM_DIVMOD_1 1
+#  endif
+# endif
+#endif
+
+#ifdef __ASSEMBLER__
+
+/* Unsigned 32 by 32 bit multiply out of four mulu.w: hi:lo = lo * b,
+   where bsw is b with its halves swapped.  t1 and t2 are scratch;
+   all of them are data registers.  */
+	.macro	UMUL_W hi, lo, b, bsw, t1, t2
+	move.l	\lo,\hi
+	swap	\hi		| hi.w = high half of a
+	move.l	\hi,\t1
+	mulu.w	\b,\t1		| a.h * b.l
+	mulu.w	\bsw,\hi	| a.h * b.h
+	move.l	\lo,\t2
+	mulu.w	\bsw,\t2	| a.l * b.h
+	mulu.w	\b,\lo		| a.l * b.l
+	add.l	\t2,\t1		| the middle products
+	jcc	1f
+	add.l	#0x10000,\hi	| carry out of them
+1:	move.l	\t1,\t2
+	swap	\t1
+	clr.w	\t1		| low half of the middle moved up
+	swap	\t2
+	and.l	#0xffff,\t2	| high half of the middle moved down
+	add.l	\t1,\lo
+	addx.l	\t2,\hi
+	.endm
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* _MPN_ASM_H */
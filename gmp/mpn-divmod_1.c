@@ -28,6 +28,10 @@ along with the GNU MP Library; if not, see
 #include "gmp.h"
 #include "gmp-impl.h"
 #include "longlong.h"
+#include "mpn-asm.h"
+
+/* The 68020 and later use m68k-divmod_1.S.  */
+#ifndef MPN_ASM_DIVMOD_1
 
 #ifndef UMUL_TIME
 #define UMUL_TIME 1
@@ -207,3 +211,5 @@ mpn_divmod_1 (quot_ptr, dividend_ptr, dividend_size, divisor_limb)
     }
     (void) dummy;
 }
+
+#endif /* MPN_ASM_DIVMOD_1 */
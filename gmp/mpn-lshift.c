@@ -21,6 +21,10 @@ along with the GNU MP Library; if not, see
 #include <features.h>
 #include "gmp.h"
 #include "gmp-impl.h"
+#include "mpn-asm.h"
+
+/* The 68020 and later and the ColdFire use m68k-lshift.S.  */
+#ifndef MPN_ASM_KERNELS
 
 /* Shift U (pointed to by UP and USIZE digits long) CNT bits to the left
    and store the USIZE least significant digits of the result at WP.
@@ -85,3 +89,5 @@ mpn_lshift (wp, up, usize, cnt)
 
   return retval;
 }
+
+#endif /* MPN_ASM_KERNELS */
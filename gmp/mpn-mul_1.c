@@ -23,6 +23,10 @@ along with the GNU MP Library; if not, see
 #include "gmp.h"
 #include "gmp-impl.h"
 #include "longlong.h"
+#include "mpn-asm.h"
+
+/* The 68020 and later and the ColdFire use m68k-mul_1.S.  */
+#ifndef MPN_ASM_KERNELS
 
 mp_limb_t
 mpn_mul_1 (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_size_t s1_size, mp_limb_t s2_limb)
@@ -53,3 +57,5 @@ mpn_mul_1 (mp_ptr res_ptr, mp_srcptr s1_ptr, mp_size_t s1_size, mp_limb_t s2_lim
 
   return cy_limb;
 }
+
+#endif /* MPN_ASM_KERNELS */
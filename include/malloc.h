@@ -12,6 +12,7 @@
 
 #define __need_size_t
 #include <stddef.h>
+#include <stdio.h>
 
 __BEGIN_DECLS
 
@@ -21,6 +22,7 @@ __EXTERN void *realloc __P ((void *__r, size_t __n));
 __EXTERN void *calloc __P ((size_t __n, size_t __size));
 __EXTERN void _malloczero __P ((int __yes));
 __EXTERN void _mallocChunkSize __P ((size_t __size));
+__EXTERN void _mallocBigSize __P ((size_t __size));
 
 __EXTERN void *_malloc __P ((unsigned long __n));
 __EXTERN void *_realloc __P ((void *_r, unsigned long __n));
@@ -37,6 +39,44 @@ __THROW __attribute_malloc__;
 /* Allocate SIZE bytes on a page boundary.  */
 extern void *valloc (size_t __size) __THROW __attribute_malloc__;
 
+/* Release free memory at the end of the heap, keeping PAD bytes.  */
+extern int malloc_trim (size_t __pad) __THROW;
+
+/* mallopt options that actually do something */
+#define M_MMAP_THRESHOLD    -3	/* requests that get a block of their own */
+#define M_PREFER_FASTRAM  -100	/* grow the heap in TT/Fast-RAM if possible */
+#define M_STRAM_ONLY      -101	/* grow the heap in ST-RAM only */
+
+/* General SVID/XPG interface to tunable parameters. */
+extern int mallopt (int __param, int __val) __THROW;
+
+/* Allocate SIZE bytes in ST-RAM, e.g. for DMA or video buffers.  */
+extern void *malloc_stram (size_t __size) __THROW __attribute_malloc__;
+
+/* SVID2/XPG mallinfo structure */
+struct mallinfo
+{
+  int arena;    /* non-mmapped space allocated from system */
+  int ordblks;  /* number of free chunks */
+  int smblks;   /* number of free chunks in the exact-size bins */
+  int hblks;    /* number of blocks of big requests */
+  int hblkhd;   /* space in blocks of big requests */
+  int usmblks;  /* always 0, preserved for backwards compatibility */
+  int fsmblks;  /* space in free chunks of the exact-size bins */
+  int uordblks; /* total allocated space */
+  int fordblks; /* total free space */
+  int keepcost; /* space malloc_trim could release */
+};
+
+/* Returns a copy of the updated current mallinfo. */
+extern struct mallinfo mallinfo (void) __THROW;
+
+/* Prints brief summary statistics on stderr. */
+extern void malloc_stats (void) __THROW;
+
+/* Output information about state of allocator to stream FP.  */
+extern int malloc_info (int __options, FILE *__fp) __THROW;
+
 __END_DECLS
   
 #endif /* _MALLOC_H */
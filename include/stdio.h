@@ -525,6 +525,15 @@ extern int __fillbf __P ((FILE *__stream));
 extern int fgetc __P ((FILE *__stream));
 extern int getc __P ((FILE *__stream));
 
+#ifdef __USE_MISC
+/* Faster version when locking is not necessary.  */
+extern int fgetc_unlocked __P ((FILE *__stream));
+#endif
+
+/* Nonzero once threads were started with tfork.  The getc and putc
+   macros then call the functions, which lock the stream.  */
+extern int __libc_threads;
+
 /* Read a character from stdin.  */
 extern int getchar __P ((void));
 
@@ -536,13 +545,13 @@ extern int getchar __P ((void));
 
 /* The C standard explicitly says this is a macro,
    so we always do the optimization for it.  */
-#define	getc(stream)	__getc(stream)
+#define	getc(stream)	(__libc_threads ? fgetc (stream) : __getc (stream))
 
 #ifdef __USE_EXTERN_INLINES
 _EXTERN_INLINE int
 getchar (void)
 {
-  return __getc (stdin);
+  return __libc_threads ? fgetc (stdin) : __getc (stdin);
 }
 #endif /* Optimizing.  */
 
@@ -584,13 +593,14 @@ extern int putchar __P ((int __c));
 
 /* The C standard explicitly says this can be a macro,
    so we always do the optimization for it.  */
-#define	putc(c, stream)	__putc ((c), (stream))
+#define	putc(c, stream)							      \
+  (__libc_threads ? fputc ((c), (stream)) : __putc ((c), (stream)))
 
 #ifdef __USE_EXTERN_INLINES
 _EXTERN_INLINE int
 putchar (int __c)
 {
-  return __putc (__c, stdout);
+  return __libc_threads ? fputc (__c, stdout) : __putc (__c, stdout);
 }
 #endif
 
@@ -64,6 +64,9 @@ typedef int (*__compar_fn_t) (__const void*, __const void*);
 typedef __compar_fn_t comparison_fn_t;
 # endif
 #endif
+#ifdef __USE_GNU
+typedef int (*__compar_d_fn_t) (__const void*, __const void*, void*);
+#endif
 
 /* Convert a string to a floating-point number.  */
 extern double atof (__const char *__nptr) __THROW;
@@ -307,6 +310,7 @@ extern void *aligned_alloc (size_t __alignment, size_t __size)
 # ifdef __atarist__
 extern void _malloczero (int __yes) __THROW;
 extern void _mallocChunkSize (size_t __siz) __THROW;
+extern void _mallocBigSize (size_t __siz) __THROW;
 # endif
 
 #endif /* __STRICT_ANSI__ */
@@ -341,6 +345,13 @@ extern void *bsearch (__const void* __key, __const void* __base,
 extern void qsort (void* __base, size_t __total_elems, 
                              size_t __size, 
                              __compar_fn_t __compar) __THROW;
+#ifdef __USE_GNU
+/* Like qsort, but ARG is passed to the comparison function as its
+   third argument.  */
+extern void qsort_r (void* __base, size_t __total_elems,
+                             size_t __size,
+                             __compar_d_fn_t __compar, void* __arg) __THROW;
+#endif
 
 extern int abs (int __x) __THROW;
 extern long labs (long __x) __THROW;
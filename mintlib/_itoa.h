@@ -23,6 +23,74 @@
 #endif
 CHAR_T * _witoa (unsigned long long int, CHAR_T *, unsigned int, int);
 
+/* "00" to "99", for writing two decimal digits at a time.  */
+extern const char _itoa_two_digits[];
+
+/* VALUE / 10000.  The plain 68000 has no 32 bit division, so there
+   this is VALUE * 0xd1b71759 >> 45 with the upper half of the product
+   built from 16 x 16 bit multiplies; this is exact for every VALUE.  */
+#define _ITOA_MULUW(a, b) \
+  ((unsigned long) (unsigned short) (a) * (unsigned short) (b))
+
+static __inline__ unsigned long __attribute__ ((unused))
+_itoa_div10000 (unsigned long value)
+{
+#if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__) || defined(__mcoldfire__)
+  return value / 10000;
+#else
+  unsigned long lo = value & 0xffff, hi = value >> 16;
+  unsigned long t, m;
+
+  t = (_ITOA_MULUW (lo, 0x1759) >> 16) + _ITOA_MULUW (lo, 0xd1b7);
+  m = (t & 0xffff) + _ITOA_MULUW (hi, 0x1759);
+  t = (t >> 16) + (m >> 16) + _ITOA_MULUW (hi, 0xd1b7);
+  return t >> 13;
+#endif
+}
+
+/* Write the decimal digits of VALUE backwards before BP, four at a
+   time as long as there are more than four, and return the first
+   digit.  Below 10000 everything is done with 16 bit multiplies:
+   R / 100 is R * 5243 >> 19 for every R < 43699.  */
+static __inline__ CHAR_T * __attribute__ ((unused))
+_itoa_dec (unsigned long value, CHAR_T *bp)
+{
+  unsigned int r, q;
+
+  while (value >= 10000)
+    {
+      unsigned long quo = _itoa_div10000 (value);
+
+      /* the remainder fits in 16 bits, so only the low halves count */
+      r = (unsigned short) (value - _ITOA_MULUW (quo, 10000));
+      q = _ITOA_MULUW (r, 5243) >> 19;
+      r -= _ITOA_MULUW (q, 100);
+      *--bp = _itoa_two_digits[2 * r + 1];
+      *--bp = _itoa_two_digits[2 * r];
+      *--bp = _itoa_two_digits[2 * q + 1];
+      *--bp = _itoa_two_digits[2 * q];
+      value = quo;
+    }
+
+  r = value;
+  if (r >= 100)
+    {
+      q = _ITOA_MULUW (r, 5243) >> 19;
+      r -= _ITOA_MULUW (q, 100);
+      *--bp = _itoa_two_digits[2 * r + 1];
+      *--bp = _itoa_two_digits[2 * r];
+      r = q;
+    }
+  if (r >= 10)
+    {
+      *--bp = _itoa_two_digits[2 * r + 1];
+      *--bp = _itoa_two_digits[2 * r];
+    }
+  else
+    *--bp = '0' + r;
+  return bp;
+}
+
 /* Convert VALUE into ASCII in base BASE (2..36).
    Write backwards starting the character just before BUFLIM.
    Return the address of the first (left-to-right) character in the number.
@@ -46,7 +114,10 @@ _itoa_word (unsigned long value, CHAR_T *buflim,
       while ((value /= Base) != 0);					      \
       break
 
-      SPECIAL (10);
+    case 10:
+      bp = _itoa_dec (value, bp);
+      break;
+
       SPECIAL (16);
       SPECIAL (8);
     default:
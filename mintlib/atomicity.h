@@ -52,6 +52,22 @@ compare_and_swap (long int *p, long int oldval, long int newval)
   *p = newval;
   return 1;
 }
+
+/* Set the top bit of the byte at P in one bus cycle and return nonzero
+   if the byte was 0 before.  tas works on the 68000 and ColdFire too.  */
+static inline int
+__attribute__ ((unused))
+test_and_set (volatile unsigned char *p)
+{
+  char ret;
+
+  __asm__ __volatile__ ("tas%.b	%1\n\t"
+			"seq	%0"
+			: "=d" (ret), "+m" (*p)
+			:
+			: "cc");
+  return ret;
+}
 #endif
 
 #endif /* atomicity.h */
@@ -0,0 +1,319 @@
+/* Allocator benchmark: runs synthetic workloads and replays recorded
+   malloc/realloc/free traces, and reports operations per second, the
+   peak footprint and the fragmentation of the heap.
+
+   Usage: bench-malloc [-n scale] [trace...]
+
+   A trace has one operation per line:
+	m ID SIZE	ID = malloc (SIZE)
+	r ID SIZE	ID = realloc (ID, SIZE)
+	f ID		free (ID)
+   where ID is a small integer naming the block.  Lines starting with
+   '#' are ignored.
+
+   The program only uses standard interfaces and mallinfo(), so it can
+   also be built natively (make bench-native) to compare with the host
+   allocator.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <time.h>
+
+#define MAXIDS 4096
+
+static char *block[MAXIDS];
+
+struct op
+{
+  char what;
+  unsigned short id;
+  unsigned long size;
+};
+
+/* the operations of the workload to run */
+static struct op *ops;
+static unsigned long nops, maxops;
+
+/* the same pseudo random numbers everywhere */
+static unsigned long seed;
+
+static unsigned long
+rnd (unsigned long n)
+{
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  return ((seed >> 8) & 0xffffffUL) % n;
+}
+
+static void
+add (char what, unsigned int id, unsigned long size)
+{
+  if (nops == maxops)
+    {
+      maxops = maxops ? 2 * maxops : 1024;
+      ops = realloc (ops, maxops * sizeof (struct op));
+      if (ops == NULL)
+	{
+	  fputs ("bench-malloc: out of memory\n", stderr);
+	  exit (1);
+	}
+    }
+  ops[nops].what = what;
+  ops[nops].id = id;
+  ops[nops].size = size;
+  nops++;
+}
+
+/* mostly small blocks, some medium, few large */
+static unsigned long
+rndsize (void)
+{
+  unsigned long r = rnd (100);
+
+  if (r < 80)
+    return 1 + rnd (128);
+  if (r < 97)
+    return 1 + rnd (4096);
+  return 1 + rnd (128 * 1024L);
+}
+
+static void
+make_lifo (unsigned long scale)
+{
+  unsigned long i, round;
+  unsigned int n = 512;
+
+  for (round = 0; round < scale; round++)
+    {
+      for (i = 0; i < n; i++)
+	add ('m', i, rndsize ());
+      for (i = n; i-- > 0; )
+	add ('f', i, 0);
+    }
+}
+
+static void
+make_fifo (unsigned long scale)
+{
+  unsigned long i, round;
+  unsigned int n = 512;
+
+  for (round = 0; round < scale; round++)
+    {
+      for (i = 0; i < n; i++)
+	add ('m', i, rndsize ());
+      for (i = 0; i < n; i++)
+	add ('f', i, 0);
+    }
+}
+
+static void
+make_churn (unsigned long scale)
+{
+  unsigned long i;
+  unsigned int n = 1024, id;
+
+  for (i = 0; i < n; i++)
+    add ('m', i, rndsize ());
+  for (i = 0; i < 1024 * scale; i++)
+    {
+      id = rnd (n);
+      if (rnd (4) == 0)
+	add ('r', id, rndsize ());
+      else
+	{
+	  add ('f', id, 0);
+	  add ('m', id, rndsize ());
+	}
+    }
+  for (i = 0; i < n; i++)
+    add ('f', i, 0);
+}
+
+static void
+make_grow (unsigned long scale)
+{
+  unsigned long i, size, cur[16];
+  unsigned int n = 16, id;
+
+  /* several buffers growing at the same time, half of them linearly
+     and half of them geometrically */
+  for (i = 0; i < scale; i++)
+    {
+      for (id = 0; id < n; id++)
+	{
+	  add ('m', id, 16);
+	  cur[id] = 16;
+	}
+      for (size = 16; size < 64 * 1024L; size += 256)
+	for (id = 0; id < n; id++)
+	  if (id & 1)
+	    add ('r', id, size);
+	  else if (cur[id] < size)
+	    {
+	      cur[id] *= 2;
+	      add ('r', id, cur[id]);
+	    }
+      for (id = 0; id < n; id++)
+	add ('f', id, 0);
+    }
+}
+
+static int
+load_trace (const char *name)
+{
+  FILE *fp = fopen (name, "r");
+  char line[128], what;
+  unsigned int id;
+  unsigned long size;
+
+  if (fp == NULL)
+    {
+      perror (name);
+      return -1;
+    }
+  while (fgets (line, sizeof line, fp) != NULL)
+    {
+      if (line[0] == '#' || line[0] == '\n')
+	continue;
+      size = 0;
+      if (sscanf (line, "%c %u %lu", &what, &id, &size) < 2
+	  || (what != 'm' && what != 'r' && what != 'f') || id >= MAXIDS)
+	{
+	  fprintf (stderr, "%s: bad line: %s", name, line);
+	  fclose (fp);
+	  return -1;
+	}
+      add (what, id, size);
+    }
+  fclose (fp);
+  return 0;
+}
+
+static unsigned long
+footprint (struct mallinfo *mi)
+{
+  return (unsigned long) mi->arena + (unsigned long) mi->hblkhd;
+}
+
+/* run the workload; with measure != 0 the heap is looked at every few
+   operations, which is too slow to do while timing */
+static int
+replay (int measure, unsigned long *peak, unsigned long *frag)
+{
+  unsigned long i, used, free_bytes;
+  struct mallinfo mi;
+  char *p;
+
+  *peak = *frag = 0;
+  for (i = 0; i < nops; i++)
+    {
+      struct op *o = &ops[i];
+
+      switch (o->what)
+	{
+	case 'm':
+	  free (block[o->id]);
+	  block[o->id] = malloc (o->size);
+	  if (o->size == 0)
+	    break;
+	  if (block[o->id] == NULL)
+	    return -1;
+	  block[o->id][0] = 1;
+	  break;
+	case 'r':
+	  if (o->size == 0)
+	    {
+	      free (block[o->id]);
+	      block[o->id] = NULL;
+	      break;
+	    }
+	  p = realloc (block[o->id], o->size);
+	  if (p == NULL)
+	    return -1;
+	  block[o->id] = p;
+	  p[o->size - 1] = 1;
+	  break;
+	case 'f':
+	  free (block[o->id]);
+	  block[o->id] = NULL;
+	  break;
+	}
+
+      if (measure && (i & 63) == 0)
+	{
+	  mi = mallinfo ();
+	  if (footprint (&mi) > *peak)
+	    {
+	      *peak = footprint (&mi);
+	      /* share of the footprint that is free at the peak */
+	      used = mi.uordblks;
+	      free_bytes = mi.fordblks;
+	      if (used + free_bytes != 0)
+		*frag = free_bytes / ((used + free_bytes) / 100 + 1);
+	    }
+	}
+    }
+
+  for (i = 0; i < MAXIDS; i++)
+    {
+      free (block[i]);
+      block[i] = NULL;
+    }
+  return 0;
+}
+
+static int
+run (const char *name)
+{
+  unsigned long peak, frag;
+  clock_t start, ticks;
+  double secs;
+
+  start = clock ();
+  if (replay (0, &peak, &frag) != 0)
+    {
+      printf ("%-12s out of memory\n", name);
+      return 1;
+    }
+  ticks = clock () - start;
+  replay (1, &peak, &frag);
+
+  secs = (double) ticks / CLOCKS_PER_SEC;
+  printf ("%-12s %8lu ops %10.0f ops/s %9lu peak %3lu%% frag\n",
+	  name, nops, secs > 0 ? nops / secs : 0.0, peak, frag);
+  nops = 0;
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  unsigned long scale = 8;
+  int result = 0, i = 1;
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    {
+      scale = strtoul (argv[2], NULL, 10);
+      i = 3;
+    }
+
+  seed = 1; make_lifo (scale); result |= run ("lifo");
+  seed = 2; make_fifo (scale); result |= run ("fifo");
+  seed = 3; make_churn (scale); result |= run ("churn");
+  seed = 4; make_grow (scale); result |= run ("grow");
+
+  for (; i < argc; i++)
+    {
+      if (load_trace (argv[i]) != 0)
+	{
+	  result = 1;
+	  continue;
+	}
+      result |= run (argv[i]);
+    }
+
+  free (ops);
+  return result;
+}
@@ -2,22 +2,102 @@
 /* written by Eric R. Smith and placed in the public domain */
 /* 5/5/92 sb -- separated for efficiency, see also putenv.c */
 
+#include <limits.h>
 #include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include "lib.h"
 
-char *
-getenv (const char *tag)
+/* Lookups go through a hash index over environ.  Besides the table it
+ * keeps a copy of the entry pointers it was built from, so that entries
+ * that were replaced, removed or cut off by a NULL in the array are
+ * noticed: a hit is only taken if the entries up to it are unchanged,
+ * and a miss only if all of them are.  Otherwise, and when environ is
+ * assigned a new array or setenv and friends bump __libc_environ_gen,
+ * the index is rebuilt.  It lives on the heap, so it is not built
+ * before _crtinit has set up the stack (_StkLim is set then); getenv
+ * scans until that.  Once there are tfork threads the index is only
+ * read, a thread that finds it stale scans instead.
+ */
+static char **idx_environ;	/* the array the index was built for */
+static unsigned long idx_gen;
+static char **idx_vars;		/* its entries then, with the NULL */
+static size_t idx_count;	/* number of entries in it */
+static size_t idx_mask;		/* size of the table - 1 */
+static unsigned short *idx_table; /* entry number + 1, or 0 */
+
+static unsigned long
+env_hash (const char *s, size_t *lenp)
+{
+	unsigned long h = 5381;
+	const char *p;
+
+	for (p = s; *p && *p != '='; p++)
+		h = (h << 5) + h + (unsigned char) *p;
+	*lenp = p - s;
+	return h;
+}
+
+/* nonzero if the first n entries of environ are those of the index */
+static int
+unchanged (size_t n)
+{
+	return memcmp (environ, idx_vars, n * sizeof (char *)) == 0;
+}
+
+static int
+build_index (void)
 {
 	char **var;
-	char *name;
-	size_t len;
+	size_t count, size, len, i;
+	unsigned long h;
 
-	if (!environ)
-		return 0;
+	free (idx_table);
+	free (idx_vars);
+	idx_table = NULL;
+	idx_vars = NULL;
+	idx_environ = NULL;
+
+	for (count = 0; environ[count] != NULL; count++)
+		;
+	if (count >= USHRT_MAX)
+		return -1;
+
+	for (size = 16; size < 2 * count; size <<= 1)
+		;
+	idx_table = calloc (size, sizeof (unsigned short));
+	idx_vars = malloc ((count + 1) * sizeof (char *));
+	if (idx_table == NULL || idx_vars == NULL) {
+		free (idx_table);
+		free (idx_vars);
+		idx_table = NULL;
+		idx_vars = NULL;
+		return -1;
+	}
+	memcpy (idx_vars, environ, (count + 1) * sizeof (char *));
+	idx_count = count;
+	idx_mask = size - 1;
+	idx_environ = environ;
+	idx_gen = __libc_environ_gen;
 
-	len = strlen (tag);
+	for (var = environ; *var != NULL; var++) {
+		h = env_hash (*var, &len);
+		for (i = h & idx_mask; idx_table[i] != 0; i = (i + 1) & idx_mask)
+			/* the first of several equal names wins */
+			if (!strncmp (environ[idx_table[i] - 1], *var, len + 1))
+				break;
+		if (idx_table[i] == 0)
+			idx_table[i] = var - environ + 1;
+	}
+	return 0;
+}
+
+/* the slow way */
+static char *
+scan (const char *tag, size_t len)
+{
+	char **var;
+	char *name;
 
 	for (var = environ; (name = *var) != 0; var++) {
 		if (!strncmp(name, tag, len) && name[len] == '=')
@@ -26,3 +106,40 @@ getenv (const char *tag)
 
 	return 0;
 }
+
+char *
+getenv (const char *tag)
+{
+	char *name;
+	size_t len, i, k;
+	unsigned long h;
+
+	if (!environ)
+		return 0;
+
+	h = env_hash (tag, &len);
+	if (tag[len] != '\0')
+		return scan (tag, strlen (tag));
+
+	if (environ != idx_environ || __libc_environ_gen != idx_gen) {
+		if (__libc_threads || _StkLim == NULL || build_index () != 0)
+			return scan (tag, len);
+	}
+
+	for (i = h & idx_mask; idx_table[i] != 0; i = (i + 1) & idx_mask) {
+		k = idx_table[i] - 1;
+		name = idx_vars[k];
+		if (!strncmp(name, tag, len) && name[len] == '=') {
+			if (unchanged (k + 1))
+				return name+len+1;
+			break;
+		}
+	}
+	if (idx_table[i] == 0 && unchanged (idx_count + 1))
+		return 0;
+
+	/* the array was changed in place */
+	if (!__libc_threads)
+		build_index ();
+	return scan (tag, len);
+}
@@ -30,14 +30,27 @@ int __libc_unix_names = 0;
 
 long __has_no_ssystem;
 
+/* Value of the _CPU cookie (0, 10, 20 ... 60), set by _checkcpu().  */
+long __libc_cpu;
+
+/* Top of TT-RAM, or 0 if unknown; memcpy() and memset() use move16 only
+   below it.  Set by __libc_main() on a 68040 or 68060.  */
+long __libc_fastram_end;
+
 BASEPAGE *_base;
 char **environ;
 
+/* Bumped by setenv and friends whenever they change environ.  */
+unsigned long __libc_environ_gen;
+
 /* total size of program area */
 unsigned long _PgmSize;
 
 /* are we an app? */
 short _app = 1;
 
+/* Set to 1 once tfork() has started a thread that runs in parallel.  */
+int __libc_threads = 0;
+
 /* Are we on a split addr mem ST.  */
 short _split_mem = 0;
@@ -65,11 +65,36 @@ extern clock_t _childtime;
 
 extern BASEPAGE *_base;
 extern char **environ;
+extern unsigned long __libc_environ_gen;
+int __add_to_environ (const char *name, const char *value, const char *combined, int replace);
 extern long __libc_argc;
 extern char **__libc_argv;
 
 extern void *_heapbase;
 extern short _split_mem;
+extern int __libc_threads;
+extern long __libc_cpu;
+extern long __libc_fastram_end;	/* top of TT-RAM, 0 if unknown */
+
+/* tfork() runs a thread on a stack of THREAD_STACKSIZE bytes aligned
+ * to its size.  Its lowest two longs hold THREAD_MAGIC and the address
+ * of the stack, which is the id of the thread; locks get it from the
+ * stack pointer without a system call.  Anything else is the main
+ * program, with the id 1.
+ */
+#define THREAD_STACKSIZE 4096L
+#define THREAD_MAGIC 0x54687264L	/* "Thrd" */
+
+static __inline__ long
+__libc_thread_id (void)
+{
+	long here;
+	long *stack = (long *) ((long) &here & ~(THREAD_STACKSIZE - 1));
+
+	if (stack[0] == THREAD_MAGIC && stack[1] == (long) stack)
+		return (long) stack;
+	return 1;
+}
 
 extern long _stksize;
 extern char *_StkLim;
@@ -171,6 +196,30 @@ void __stdio_check_funcs (FILE *);
 /* Prototype for helper functions.  */
 int __fxprintf (FILE *__fp, const char *__fmt, ...) __attribute__ ((__format__ (__printf__, 2, 3)));
 void __stdio_init_stream(FILE *);
+size_t __stdio_bufsize (FILE *);
+ssize_t __stdio_gather_write (FILE *, const char *, size_t);
+
+/* Default size of stdio buffers if not 0, in stdio-globals.c.  */
+extern size_t __DEFAULT_BUFSIZ__;
+
+/* The lock of a stream, see stdio/lockfile.c.  */
+struct __stdio_lock
+{
+  volatile long owner;		/* pid of the thread holding it, or 0 */
+  volatile unsigned long count;	/* how often the owner took it */
+};
+
+void __flockfile (FILE *);
+void __funlockfile (FILE *);
+int __ftrylockfile (FILE *);
+void __stdio_unlock (struct __stdio_lock *);
+
+/* The stdio functions lock the stream they work on once threads were
+   started with tfork.  */
+#define __STDIO_LOCK(stream) \
+  do { if (__libc_threads) __flockfile (stream); } while (0)
+#define __STDIO_UNLOCK(stream) \
+  do { if (__libc_threads) __funlockfile (stream); } while (0)
 
 #ifdef _PRINTF_H
 int __printf_fp (FILE *fp, const struct printf_info *info, const void *const *args);
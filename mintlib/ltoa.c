@@ -1,22 +1,20 @@
 
 #include <string.h>
 #include "lib.h"
-
-static char const _numstr[] = "0123456789ABCDEF";
+#include "_itoa.h"
 
 char *
 _ultoa(unsigned long n, char *buffer, int radix)
 {
-	register char *p = buffer;
-	
-	do {
-		*p++ = _numstr[n % radix];	/* grab each digit */
-	}
-	while((n /= radix) > 0);
-	
-	*p = '\0';
-	
-	return strrev(buffer);			/* reverse and return it */
+	char tmp[sizeof n * 8];
+	char *p;
+
+	/* _itoa_word converts base 10 without dividing */
+	p = _itoa_word(n, tmp + sizeof tmp, radix, 1);
+	memcpy(buffer, p, tmp + sizeof tmp - p);
+	buffer[tmp + sizeof tmp - p] = '\0';
+
+	return buffer;
 }
 
 char *
@@ -74,6 +74,15 @@ init_stream_mode(FILE* stream)
 
 void __libc_main (long _argc, char **_argv, char **_envp);
 
+/* ramtop is only valid together with the magic number in ramvalid */
+static long
+read_fastram_end (void)
+{
+	if (*ramvalid != 0x1357bd13UL)
+		return 0;
+	return *ramtop;
+}
+
 void
 __libc_main (long _argc, char **_argv, char **_envp)
 {
@@ -100,6 +109,13 @@ __libc_main (long _argc, char **_argv, char **_envp)
 	if (_app)
 		_pdomain = Pdomain(1);	/* set MiNT domain */
 
+	/* where memcpy() and memset() may use move16 */
+	if (__libc_cpu >= 40) {
+		l = Supexec (read_fastram_end);
+		if (l > 0)
+			__libc_fastram_end = l;
+	}
+
 	/* Check if we are suid or guid.  We simply use the bare operating
 	 * system calls because we only check for differences.  If it fails
 	 * once it will always fail.
@@ -0,0 +1,228 @@
+/* mallinfo, malloc_stats, malloc_info: report what the allocator is doing */
+
+#include <stddef.h>	/* for size_t */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <malloc.h>
+#include <mint/mintbind.h>
+#include "lib.h"
+#include "malloc_int.h"
+#include "atomicity.h"
+
+
+/* free chunks per bin, for malloc_info() */
+struct bin_summary
+{
+	unsigned long min, max, total, count;
+};
+
+struct heap_summary
+{
+	unsigned long hunks;		/* hunks in the heap */
+	unsigned long heap_bytes;	/* bytes in those hunks */
+	unsigned long big_hunks;	/* hunks of big requests */
+	unsigned long big_bytes;	/* bytes in those hunks */
+	unsigned long free_chunks;
+	unsigned long free_bytes;
+	unsigned long small_chunks;	/* free chunks in the exact-size bins */
+	unsigned long small_bytes;
+	unsigned long largest_free;
+	unsigned long trailing_free;	/* what malloc_trim() could release */
+	unsigned long mallocs;		/* calls, from _mchunk_stats */
+	unsigned long frees;
+	unsigned long reallocs;
+	struct bin_summary bins[NBINS];
+};
+
+/* collect the figures with the heap locked; nothing in here may
+ * call malloc, so printing is left to the callers
+ */
+static void
+summarize(struct heap_summary *hs)
+{
+	struct mem_chunk *b, *q;
+	struct bin_summary *bin;
+	int i;
+
+	memset(hs, 0, sizeof(*hs));
+
+	MALLOC_LOCK();
+
+	for (b = _mchunk_hunk_list.next; b; b = b->next)
+	{
+		if (HUNK(b)->flags & HUNK_BIG)
+		{
+			hs->big_hunks++;
+			hs->big_bytes += BORDER_EXTRA + ALLOC_SIZE(b);
+		}
+		else
+		{
+			hs->hunks++;
+			hs->heap_bytes += BORDER_EXTRA + ALLOC_SIZE(b);
+		}
+		if (!(HUNK(b)->flags & HUNK_HEAP))
+		{
+			/* free chunk below the fence */
+			q = ((struct mem_chunk *) ((char *) b + BORDER_EXTRA + ALLOC_SIZE(b) - FENCE_EXTRA))->next;
+			if (q != NULL)
+				hs->trailing_free += q->size;
+		}
+	}
+
+	for (i = 0; i < NBINS; i++)
+	{
+		bin = &hs->bins[i];
+		for (q = _mchunk_bins[i]; q; q = q->next)
+		{
+			hs->free_chunks++;
+			hs->free_bytes += q->size;
+			if (i < NSMALLBINS)
+			{
+				hs->small_chunks++;
+				hs->small_bytes += q->size;
+			}
+			if (q->size > hs->largest_free)
+				hs->largest_free = q->size;
+
+			if (bin->count == 0 || q->size < bin->min)
+				bin->min = q->size;
+			if (q->size > bin->max)
+				bin->max = q->size;
+			bin->total += q->size;
+			bin->count++;
+		}
+	}
+
+	hs->mallocs = _mchunk_stats.mallocs;
+	hs->frees = _mchunk_stats.frees;
+	hs->reallocs = _mchunk_stats.reallocs;
+	_mchunk_tcache_calls(&hs->mallocs, &hs->frees);
+
+	MALLOC_UNLOCK();
+}
+
+/* The figures go to a static summary rather than the stack, which is
+ * only 4 KB in a thread.  The callers take it one at a time; the heap
+ * stays unlocked while they print, since fprintf may call malloc.
+ */
+static struct heap_summary summary;
+static volatile unsigned char summary_busy;
+
+static struct heap_summary *
+summary_get(void)
+{
+	if (__libc_threads)
+		while (!test_and_set(&summary_busy))
+			(void) Syield();
+	summarize(&summary);
+	return &summary;
+}
+
+static void
+summary_release(void)
+{
+	summary_busy = 0;
+}
+
+
+__typeof__(mallinfo) __mallinfo;
+
+struct mallinfo
+__mallinfo(void)
+{
+	struct heap_summary *hs;
+	struct mallinfo mi;
+
+	hs = summary_get();
+
+	mi.arena = hs->heap_bytes;
+	mi.ordblks = hs->free_chunks;
+	mi.smblks = hs->small_chunks;
+	mi.hblks = hs->big_hunks;
+	mi.hblkhd = hs->big_bytes;
+	mi.usmblks = 0;
+	mi.fsmblks = hs->small_bytes;
+	mi.uordblks = hs->heap_bytes + hs->big_bytes - hs->free_bytes;
+	mi.fordblks = hs->free_bytes;
+	mi.keepcost = hs->trailing_free;
+	summary_release();
+
+	return mi;
+}
+weak_alias(__mallinfo, mallinfo)
+
+
+__typeof__(malloc_stats) __malloc_stats;
+
+void
+__malloc_stats(void)
+{
+	struct heap_summary *hs;
+	unsigned long frag;
+
+	hs = summary_get();
+
+	/* share of the free memory that is not in the largest block */
+	frag = 0;
+	if (hs->free_bytes != 0)
+		frag = (hs->free_bytes - hs->largest_free) / (hs->free_bytes / 100 + 1);
+
+	fprintf(stderr, "system bytes     = %10lu\n", hs->heap_bytes + hs->big_bytes);
+	fprintf(stderr, "in use bytes     = %10lu\n", hs->heap_bytes + hs->big_bytes - hs->free_bytes);
+	fprintf(stderr, "free bytes       = %10lu in %lu chunks\n", hs->free_bytes, hs->free_chunks);
+	fprintf(stderr, "largest free     = %10lu\n", hs->largest_free);
+	fprintf(stderr, "fragmentation    = %9lu%%\n", frag);
+	fprintf(stderr, "heap hunks       = %10lu\n", hs->hunks);
+	fprintf(stderr, "big hunks        = %10lu (%lu bytes)\n", hs->big_hunks, hs->big_bytes);
+	fprintf(stderr, "sbrk bytes       = %10lu\n", _mchunk_stats.sbrk_bytes);
+	fprintf(stderr, "Mxalloc bytes    = %10lu\n", _mchunk_stats.mxalloc_bytes);
+	fprintf(stderr, "malloc calls     = %10lu\n", hs->mallocs);
+	fprintf(stderr, "free calls       = %10lu\n", hs->frees);
+	fprintf(stderr, "realloc calls    = %10lu\n", hs->reallocs);
+	summary_release();
+}
+weak_alias(__malloc_stats, malloc_stats)
+
+
+__typeof__(malloc_info) __malloc_info;
+
+int
+__malloc_info(int options, FILE *fp)
+{
+	struct heap_summary *hs;
+	int i;
+
+	/* no options are defined yet */
+	if (options != 0)
+		return -1;
+
+	hs = summary_get();
+
+	fputs("<malloc version=\"1\">\n<heap nr=\"0\">\n<sizes>\n", fp);
+	for (i = 0; i < NBINS; i++)
+	{
+		if (hs->bins[i].count == 0)
+			continue;
+		fprintf(fp, "<size from=\"%lu\" to=\"%lu\" total=\"%lu\" count=\"%lu\"/>\n",
+			hs->bins[i].min, hs->bins[i].max, hs->bins[i].total, hs->bins[i].count);
+	}
+	fputs("</sizes>\n", fp);
+	fprintf(fp, "<total type=\"free\" count=\"%lu\" size=\"%lu\"/>\n",
+		hs->free_chunks, hs->free_bytes);
+	fprintf(fp, "<total type=\"largest\" size=\"%lu\"/>\n", hs->largest_free);
+	fprintf(fp, "<total type=\"trim\" size=\"%lu\"/>\n", hs->trailing_free);
+	fprintf(fp, "<system type=\"current\" size=\"%lu\"/>\n", hs->heap_bytes);
+	fprintf(fp, "<system type=\"sbrk\" size=\"%lu\"/>\n", _mchunk_stats.sbrk_bytes);
+	fprintf(fp, "<system type=\"mxalloc\" size=\"%lu\"/>\n", _mchunk_stats.mxalloc_bytes);
+	fprintf(fp, "<aspace type=\"hunks\" count=\"%lu\"/>\n", hs->hunks);
+	fprintf(fp, "<aspace type=\"big\" count=\"%lu\" size=\"%lu\" total=\"%lu\"/>\n",
+		hs->big_hunks, hs->big_bytes, _mchunk_stats.big_bytes);
+	fprintf(fp, "<calls malloc=\"%lu\" free=\"%lu\" realloc=\"%lu\"/>\n",
+		hs->mallocs, hs->frees, hs->reallocs);
+	fputs("</heap>\n</malloc>\n", fp);
+	summary_release();
+
+	return 0;
+}
+weak_alias(__malloc_info, malloc_info)
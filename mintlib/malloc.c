@@ -8,14 +8,18 @@
 #include <compiler.h>
 #include <stddef.h>	/* for size_t */
 #include <stdlib.h>
+#include <malloc.h>
 #include <memory.h>
 #include <string.h>
+#include <errno.h>
 #define NDEBUG
 #include <assert.h>
 #include <unistd.h>
 #include <osbind.h>
+#include <mint/mintbind.h>
 #include "lib.h"
 #include "malloc_int.h"
+#include "atomicity.h"
 
 
 /* CAUTION: use _mallocChunkSize() to tailor to your environment,
@@ -31,6 +35,23 @@ __typeof__(_mallocChunkSize) __mallocChunkSize;
 void __mallocChunkSize(size_t siz) { MAXHUNK = MINHUNK = siz; }
 weak_alias(__mallocChunkSize, _mallocChunkSize)
 
+/* requests of at least this size get a GEMDOS block of their own,
+ * which is given back with Mfree as soon as they are freed
+ */
+static size_t BIGALLOC = 64 * 1024L;
+
+/* tune big allocation threshold; 0 turns it off */
+__typeof__(_mallocBigSize) __mallocBigSize;
+void __mallocBigSize(size_t siz) { BIGALLOC = siz; }
+weak_alias(__mallocBigSize, _mallocBigSize)
+
+/* GEMDOS pool to take new hunks from with Mxalloc, or -1 to
+ * use __sbrk; set with mallopt()
+ */
+#define MX_STRAM 0
+#define MX_PREFTTRAM 3
+static int MXMODE = -1;
+
 /* flag to control zero'ing of malloc'ed chunks */
 static int ZeroMallocs = 0;
 
@@ -39,100 +60,405 @@ __typeof__(_malloczero) __malloczero;
 void __malloczero(int yes) { ZeroMallocs = yes; }
 weak_alias(__malloczero, _malloczero)
 
-/* linked list of free blocks struct defined in lib.h */
-struct mem_chunk _mchunk_free_list = { VAL_FREE, NULL, 0L };
+/* set allocation policy */
+__typeof__(mallopt) __mallopt;
 
+int
+__mallopt(int param, int value)
+{
+	switch (param)
+	{
+	case M_MMAP_THRESHOLD:
+		if (value < 0)
+			return 0;
+		BIGALLOC = value;
+		return 1;
+	case M_PREFER_FASTRAM:
+		MXMODE = value ? MX_PREFTTRAM : -1;
+		return 1;
+	case M_STRAM_ONLY:
+		MXMODE = value ? MX_STRAM : -1;
+		return 1;
+	}
+	return 0;
+}
+weak_alias(__mallopt, mallopt)
 
-void *
-__malloc(size_t n)
+/* linked list of hunks struct defined in malloc_int.h */
+struct mem_chunk _mchunk_hunk_list = { VAL_BORDER, NULL, 0L };
+
+/* size-class bins of free chunks */
+struct mem_chunk *_mchunk_bins[NBINS];
+unsigned long _mchunk_binmap[BINMAP_WORDS];
+
+/* counters for mallinfo() */
+struct mem_stats _mchunk_stats;
+
+/* fence of the hunk last carved from _heapbase */
+static struct mem_chunk *heap_fence;
+
+/* true if the hunk ending in heap_fence can be extended with __sbrk */
+#define HEAP_TOP_GROWABLE() \
+	((!_split_mem) && _heapbase != NULL && heap_fence != NULL \
+	 && (char *) heap_fence + FENCE_EXTRA == (char *) _heapbase)
+
+
+static int
+bin_index(unsigned long sz)
 {
-	struct mem_chunk *p, *q;
-	unsigned long sz;
+	int i;
 
-	/* add a mem_chunk to required size and round up */
-	n = (n + sizeof(struct mem_chunk) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1);
+	if (sz < SMALLBIN_LIMIT)
+		return sz / MALLOC_ALIGNMENT;
+
+	/* one bin per power of two above the small bins */
+	i = NSMALLBINS + (8 * sizeof(unsigned long) - 1) - __builtin_clzl(sz / SMALLBIN_LIMIT);
+	if (i >= NBINS)
+		i = NBINS - 1;
+	return i;
+}
+
+void
+_mchunk_bin_insert(struct mem_chunk *ch)
+{
+	int i = bin_index(ch->size);
+	struct mem_chunk *head = _mchunk_bins[i];
 
-	/* look for first block big enough in free list */
-	p = &_mchunk_free_list;
-	q = _mchunk_free_list.next;
-	while (q && (q->size < n || q->valid == VAL_BORDER))
+	BIN_PREV(ch) = NULL;
+	ch->next = head;
+	if (head)
+		BIN_PREV(head) = ch;
+	else
+		_mchunk_binmap[i / BINMAP_BITS] |= 1UL << (i % BINMAP_BITS);
+	_mchunk_bins[i] = ch;
+}
+
+void
+_mchunk_bin_remove(struct mem_chunk *ch)
+{
+	struct mem_chunk *prev = BIN_PREV(ch);
+	struct mem_chunk *next = ch->next;
+
+	if (next)
+		BIN_PREV(next) = prev;
+	if (prev)
+		prev->next = next;
+	else
 	{
-		p = q;
-		q = q->next;
+		int i = bin_index(ch->size);
+
+		_mchunk_bins[i] = next;
+		if (next == NULL)
+			_mchunk_binmap[i / BINMAP_BITS] &= ~(1UL << (i % BINMAP_BITS));
 	}
+}
+
+/* find a free chunk of at least n bytes, or NULL */
+static struct mem_chunk *
+bin_find(unsigned long n)
+{
+	struct mem_chunk *q;
+	unsigned long m;
+	int i, w;
 
-	/* if not enough memory, get more from the system */
-	if (q == NULL) 
+	i = bin_index(n);
+	if (i >= NSMALLBINS)
 	{
-		if (((!_split_mem) && (_heapbase != NULL))
-		    || n + BORDER_EXTRA > MINHUNK)
-		{
-			sz = n;
-			if (_heapbase == NULL)
-				sz += BORDER_EXTRA;
-		}
-		else
-		{
-			sz = MINHUNK;
-			if (MINHUNK < MAXHUNK)
-				MINHUNK *= 2;
-		}
-		if (_split_mem || _heapbase == NULL)
-		{
-			static int page_size = 0;
-			
-			if (!page_size)
-				page_size = getpagesize ();
-			
-			sz = (sz + page_size - 1) & -page_size;
-		}
+		/* range bin: first fit within it */
+		for (q = _mchunk_bins[i]; q; q = q->next)
+			if (q->size >= n)
+				return q;
+		i++;
+	}
 
-		q = (struct mem_chunk * ) __sbrk(sz);
-		if (((long) q) == -1) /* can't alloc any more? */
+	/* the head of any non-empty bin from i on is big enough */
+	w = i / BINMAP_BITS;
+	if (w >= BINMAP_WORDS)
+		return NULL;
+	m = _mchunk_binmap[w] & (~0UL << (i % BINMAP_BITS));
+	while (m == 0)
+	{
+		if (++w >= BINMAP_WORDS)
 			return NULL;
+		m = _mchunk_binmap[w];
+	}
+	return _mchunk_bins[w * BINMAP_BITS + __builtin_ctzl(m)];
+}
+
+static void
+hunk_unlink(struct mem_chunk *b)
+{
+	HUNK(b)->prev->next = b->next;
+	if (b->next)
+		HUNK(b->next)->prev = HUNK(b)->prev;
+}
+
+/* set up the border chunk and the fence of a new hunk of sz bytes at b
+ * and link it into the hunk list; returns the free chunk in between
+ */
+static struct mem_chunk *
+hunk_init(struct mem_chunk *b, unsigned long sz)
+{
+	struct mem_chunk *q, *f;
+
+	b->valid = VAL_BORDER;
+	b->size = BORDER_EXTRA;
+	ALLOC_SIZE(b) = sz - BORDER_EXTRA;
+	HUNK(b)->flags = 0;
+	HUNK(b)->prev = &_mchunk_hunk_list;
+	b->next = _mchunk_hunk_list.next;
+	if (b->next)
+		HUNK(b->next)->prev = b;
+	_mchunk_hunk_list.next = b;
+
+	q = (struct mem_chunk *) ((long) b + BORDER_EXTRA);
+	q->valid = VAL_FREE;
+	q->size = sz - BORDER_EXTRA - FENCE_EXTRA;
+	q->next = NULL;
+
+	f = NEXT_CHUNK(q);
+	f->valid = VAL_BORDER;
+	f->size = FENCE_EXTRA;
+	f->next = q;
+	FENCE_BORDER(f) = b;
+
+	return q;
+}
+
+/* extend the topmost heap hunk so that its last free chunk has n
+ * bytes; returns that chunk, which is not on any bin, or NULL
+ */
+static struct mem_chunk *
+grow_top(unsigned long n)
+{
+	struct mem_chunk *b, *q, *f;
+	unsigned long sz;
+
+	/* the old fence becomes part of a free chunk, together with
+	 * the free chunk below it
+	 */
+	f = heap_fence;
+	q = f->next;
+	sz = n;
+	if (q)
+		sz -= q->size;
+	if (__sbrk(sz) == (void *) -1)
+		return NULL;
+	_mchunk_stats.sbrk_bytes += sz;
+
+	b = FENCE_BORDER(f);
+	ALLOC_SIZE(b) += sz;
+	if (q)
+	{
+		_mchunk_bin_remove(q);
+		q->size += sz;
+	}
+	else
+	{
+		q = f;
+		q->size = sz;
+		q->next = NULL;
+	}
+	q->valid = VAL_FREE;
 
-		/* Note: q may be below the highest allocated chunk */
-		p = &_mchunk_free_list;
-		while (p->next && q > p->next)
-			p = p->next;
+	f = heap_fence = NEXT_CHUNK(q);
+	f->valid = VAL_BORDER;
+	f->size = FENCE_EXTRA;
+	f->next = q;
+	FENCE_BORDER(f) = b;
 
-		if (_heapbase == NULL)
+	return q;
+}
+
+/* size of a new hunk for a request of n bytes */
+static unsigned long
+hunk_size(unsigned long n, int from_heap)
+{
+	unsigned long sz;
+
+	if (from_heap || n + BORDER_EXTRA + FENCE_EXTRA > MINHUNK)
+	{
+		sz = n + BORDER_EXTRA + FENCE_EXTRA;
+	}
+	else
+	{
+		sz = MINHUNK;
+		if (MINHUNK < MAXHUNK)
+			MINHUNK *= 2;
+	}
+	if (!from_heap)
+	{
+		static int page_size = 0;
+		
+		if (!page_size)
+			page_size = getpagesize ();
+		
+		sz = (sz + page_size - 1) & -page_size;
+	}
+	return sz;
+}
+
+/* Mxalloc sz bytes from the given pool; on TOS versions without
+ * Mxalloc there is only ST-RAM, so plain Malloc will do
+ */
+static struct mem_chunk *
+pool_alloc(unsigned long sz, int mode)
+{
+	long r;
+
+	if (mode < 0)
+		return (struct mem_chunk *) Malloc(sz);
+
+	r = Mxalloc(sz, mode);
+	if (r == -32)	/* EINVFN */
+		r = Malloc(sz);
+	return (struct mem_chunk *) r;
+}
+
+/* get more memory from the system; returns a free chunk of at
+ * least n bytes that is not on any bin
+ */
+static struct mem_chunk *
+grow(unsigned long n)
+{
+	struct mem_chunk *b, *q;
+	unsigned long sz;
+
+	if (MXMODE >= 0)
+	{
+		/* a new hunk from the requested pool */
+		sz = hunk_size(n, 0);
+		b = pool_alloc(sz, MXMODE);
+		if (b != NULL)
 		{
-			q->size = BORDER_EXTRA;
-			sz -= BORDER_EXTRA;
-			q->valid = VAL_BORDER;
-			ALLOC_SIZE (q) = sz;
-			q->next = (struct mem_chunk *) ((long) q + BORDER_EXTRA);
-			q->next->next = p->next;
-			p = p->next = q;
-			q = q->next;
+			_mchunk_stats.mxalloc_bytes += sz;
+			return hunk_init(b, sz);
 		}
+		if (MXMODE == MX_STRAM)
+			return NULL;
+		/* otherwise fall back to whatever __sbrk gives us */
+	}
+
+	if (HEAP_TOP_GROWABLE())
+		return grow_top(n);
+
+	sz = hunk_size(n, (!_split_mem) && (_heapbase != NULL));
+
+	b = (struct mem_chunk * ) __sbrk(sz);
+	if (((long) b) == -1) /* can't alloc any more? */
+		return NULL;
+	_mchunk_stats.sbrk_bytes += sz;
+
+	q = hunk_init(b, sz);
+
+	/* __sbrk may have switched over to our own heap */
+	if ((!_split_mem) && (_heapbase != NULL))
+	{
+		HUNK(b)->flags |= HUNK_HEAP;
+		heap_fence = NEXT_CHUNK(q);
+	}
+
+	return q;
+}
+
+/* get a GEMDOS block of its own for a large request of n bytes from
+ * the given pool; returns a free chunk of exactly n bytes that is not
+ * on any bin
+ */
+static struct mem_chunk *
+grow_big(unsigned long n, int mode)
+{
+	struct mem_chunk *b, *q;
+
+	b = pool_alloc(n + BORDER_EXTRA + FENCE_EXTRA, mode);
+	if (b == NULL)
+		return NULL;
+	_mchunk_stats.big_bytes += n + BORDER_EXTRA + FENCE_EXTRA;
+
+	q = hunk_init(b, n + BORDER_EXTRA + FENCE_EXTRA);
+	HUNK(b)->flags |= HUNK_BIG;
+	return q;
+}
+
+/* grow the allocated chunk ch by n bytes in place, if it is the last
+ * chunk (possibly followed by a free one) of the topmost heap hunk;
+ * returns nonzero on success
+ */
+int
+_mchunk_extend_top(struct mem_chunk *ch, unsigned long n)
+{
+	struct mem_chunk *q;
+
+	q = NEXT_CHUNK(ch);
+	if (q->valid == VAL_FREE)
+		q = NEXT_CHUNK(q);
+	if (q != heap_fence || !HEAP_TOP_GROWABLE())
+		return 0;
+
+	/* the old fence must still have room for a chunk header */
+	if (n < MIN_CHUNK)
+		n = MIN_CHUNK;
+	q = grow_top(n);
+	if (q == NULL)
+		return 0;
+
+	assert(q == NEXT_CHUNK(ch));
+	ch->size += q->size;
+	NEXT_CHUNK(ch)->next = NULL;
+	return 1;
+}
+
+
+void *
+_mchunk_malloc(size_t n)
+{
+	struct mem_chunk *q, *s;
+
+	/* add a mem_chunk to required size and round up */
+	n = (n + sizeof(struct mem_chunk) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1);
+	if (n < MIN_CHUNK)
+		n = MIN_CHUNK;
+
+	q = NULL;
+
+	/* big requests bypass the heap */
+	if (BIGALLOC != 0 && n >= BIGALLOC)
+		q = grow_big(n, MXMODE);
+
+	if (q == NULL)
+	{
+		/* look for a block big enough in the bins */
+		q = bin_find(n);
+		if (q != NULL)
+			_mchunk_bin_remove(q);
 		else
 		{
-			q->next = p->next;
-			p->next = q;
+			/* if not enough memory, get more from the system */
+			q = grow(n);
+			if (q == NULL)
+				return NULL;
 		}
-
-		q->size = sz;
-		q->valid = VAL_FREE;
 	}
 
-	if (q->size > n + sizeof(struct mem_chunk))
+	if (q->size >= n + MIN_CHUNK)
 	{
-		/* split, leave part of free list */
+		/* split, leave lower part free */
 		q->size -= n;
-		q = (struct mem_chunk * )(((long) q) + q->size);
+		_mchunk_bin_insert(q);
+		s = q;
+		q = NEXT_CHUNK(q);
 		q->size = n;
 		q->valid = VAL_ALLOC;
+		q->next = s;
 	}
 	else
 	{
-		/* just unlink it */
-		p->next = q->next;
+		/* just take it */
 		q->valid = VAL_ALLOC;
+		q->next = NULL;
 	}
+	NEXT_CHUNK(q)->next = NULL;
 
-	q->next = NULL;	
 	q++; /* hand back ptr to after chunk desc */
 
 	if (ZeroMallocs)
@@ -140,12 +466,46 @@ __malloc(size_t n)
 
 	return (void *) q;
 }
-weak_alias(__malloc, malloc)
+
+/* allocate n bytes in ST-RAM, whatever the policy, for buffers that
+ * are used for DMA or by the video hardware; every such block is a
+ * GEMDOS block of its own
+ */
+__typeof__(malloc_stram) __malloc_stram;
+
+void *
+__malloc_stram(size_t n)
+{
+	struct mem_chunk *q;
+
+	n = (n + sizeof(struct mem_chunk) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1);
+	if (n < MIN_CHUNK)
+		n = MIN_CHUNK;
+
+	MALLOC_LOCK();
+	_mchunk_stats.mallocs++;
+	q = grow_big(n, MX_STRAM);
+	MALLOC_UNLOCK();
+	if (q == NULL)
+		return NULL;
+
+	q->valid = VAL_ALLOC;
+	q->next = NULL;
+	NEXT_CHUNK(q)->next = NULL;
+
+	q++; /* hand back ptr to after chunk desc */
+
+	if (ZeroMallocs)
+		memset(q, 0, (size_t)(n - sizeof(struct mem_chunk)));
+
+	return (void *) q;
+}
+weak_alias(__malloc_stram, malloc_stram)
 
 void
-__free(void *param)
+_mchunk_free(void *param)
 {
-	struct mem_chunk *o, *p, *q, *s;
+	struct mem_chunk *b, *p, *s;
 	struct mem_chunk *r = (struct mem_chunk *) param;
 
 	/* free(NULL) should do nothing */
@@ -159,106 +519,281 @@ __free(void *param)
 		return;
 
 	r->valid = VAL_FREE;
-
-	/* stick it into free list, preserving ascending address order */
-	o = NULL;
-	p = &_mchunk_free_list;
-	q = _mchunk_free_list.next;
-	while (q && q < r) 
-	{
-		o = p;
-		p = q;
-		q = q->next;
-	}
+	p = r->next;
 
 	/* merge after if possible */
-	s = (struct mem_chunk *)(((long) r) + r->size);
-	if (q && s >= q && q->valid != VAL_BORDER)
+	s = NEXT_CHUNK(r);
+	if (s->valid == VAL_FREE)
 	{
-		assert(s == q);
-		if (s != q)
-			return;
-		r->size += q->size;
-		q = q->next;
+		_mchunk_bin_remove(s);
+		r->size += s->size;
 		s->size = 0;
 		s->next = NULL;
 	}
-	r->next = q;
 
-	/* merge before if possible, otherwise link it in */
-	s = (struct mem_chunk * )(((long) p) + p->size);
-	if (q && s >= r && p != &_mchunk_free_list)
+	/* merge before if possible */
+	if (p)
 	{
-		/* remember: r may be below &_mchunk_free_list in memory */
-		assert(s == r);
-		if (s != r)
-			return;
-		if (p->valid == VAL_BORDER)
-		{
-			if (ALLOC_SIZE(p) == r->size)
-			{
-				o->next = r->next;
-				Mfree (p);
-			}
-			else
-				p->next = r;
-
-			return;
-		}
-
+		assert(p->valid == VAL_FREE && NEXT_CHUNK(p) == r);
+		_mchunk_bin_remove(p);
 		p->size += r->size;
-		p->next = r->next;
 		r->size = 0;
 		r->next = NULL;
+		r = p;
+	}
 
-		s = (struct mem_chunk *)(((long) p) + p->size);
-		if ((!_split_mem) && _heapbase != NULL &&
-		    s >= (struct mem_chunk *) _heapbase &&
-		    s < (struct mem_chunk *) ((char *)_heapbase + _stksize))
+	s = NEXT_CHUNK(r);
+	s->next = r;
+	if (s->valid == VAL_BORDER)
+	{
+		/* last chunk of its hunk */
+		b = FENCE_BORDER(s);
+		if (HUNK(b)->flags & HUNK_HEAP)
 		{
-			assert(s == (struct mem_chunk *) _heapbase);
-			if (s != (struct mem_chunk *) _heapbase)
+			/* give it back to the heap if it is at the top */
+			if ((char *) s + FENCE_EXTRA == (char *) _heapbase)
+			{
+				_stksize += r->size;
+				_heapbase = (char *) _heapbase - r->size;
+				ALLOC_SIZE(b) -= r->size;
+				if ((char *) b + BORDER_EXTRA == (char *) r)
+				{
+					hunk_unlink(b);
+					_stksize += BORDER_EXTRA + FENCE_EXTRA;
+					_heapbase = (void *) b;
+					heap_fence = NULL;
+				}
+				else
+				{
+					r->valid = VAL_BORDER;
+					r->size = FENCE_EXTRA;
+					r->next = NULL;
+					FENCE_BORDER(r) = b;
+					heap_fence = r;
+				}
 				return;
-			_heapbase = (void *) p;
-			_stksize += p->size;
-			o->next = p->next; /* o is always != NULL here */
+			}
 		}
-		else if (o->valid == VAL_BORDER && ALLOC_SIZE(o) == p->size)
+		else if ((char *) b + BORDER_EXTRA == (char *) r)
 		{
-			q = &_mchunk_free_list;
-			s = q->next;
-			while (s && s < o)
-			{
-				q = s;
-				s = q->next;
-			}
-			if (s)
-			{
-				assert (s == o);
-				if (s != o)
-					return;
-				q->next = p->next;
-				Mfree (o);
-			}
+			/* the whole hunk is free */
+			hunk_unlink(b);
+			Mfree (b);
+			return;
 		}
 	}
-	else
-        {
-		s = (struct mem_chunk * )(((long) r) + r->size);
-		if ((!_split_mem) && _heapbase != NULL &&
-		    s >= (struct mem_chunk *) _heapbase &&
-		    s < (struct mem_chunk *) ((char *)_heapbase + _stksize))
-		{
-			assert(s == (struct mem_chunk *) _heapbase);
-			if (s != (struct mem_chunk *) _heapbase)
-				return;
-			_heapbase = (void *) r;
-			_stksize += r->size;
 
-			p->next = r->next;
+	_mchunk_bin_insert(r);
+}
+
+
+/* Threads started with tfork() share our memory.  Once there are any,
+ * the heap is protected by a lock, and each thread keeps a few small
+ * chunks that it freed in a cache of its own, so that most small
+ * allocations do not need to take the lock.  Cached chunks are marked
+ * VAL_CACHED, so they are neither merged nor freed twice.
+ */
+#if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__)
+
+static volatile long malloc_lock;
+
+void
+_mchunk_lock(void)
+{
+	while (!compare_and_swap((long *) &malloc_lock, 0, 1))
+		(void) Syield();
+}
+
+void
+_mchunk_unlock(void)
+{
+	malloc_lock = 0;
+}
+
+#else
+
+/* no cas on the 68000 and ColdFire, use a MiNT semaphore */
+static long malloc_sem;
+
+static void
+malloc_sem_destroy(void)
+{
+	if (Psemaphore(2, malloc_sem, -1) == 0)
+		(void) Psemaphore(1, malloc_sem, 0);
+}
+
+void
+_mchunk_lock(void)
+{
+	if (malloc_sem == 0)
+	{
+		long id = ((long) 'M' << 24) | ((long) 'L' << 16) | (((long) _base >> 8) & 0xffff);
+
+		/* creating it also grabs it; if another thread was faster,
+		 * we just wait for it below
+		 */
+		if (Psemaphore(0, id, 0) == 0)
+		{
+			malloc_sem = id;
+			atexit(malloc_sem_destroy);
+			return;
 		}
-		else
-			p->next = r;
+		malloc_sem = id;
 	}
+	(void) Psemaphore(2, malloc_sem, -1);
+}
+
+void
+_mchunk_unlock(void)
+{
+	(void) Psemaphore(3, malloc_sem, 0);
+}
+
+#endif
+
+#define TCACHE_SLOTS 8
+#define TCACHE_BINS 32		/* chunks below TCACHE_BINS * MALLOC_ALIGNMENT */
+#define TCACHE_DEPTH 8
+
+/* cached chunks are linked through their user data */
+#define TCACHE_NEXT(ch) (*(struct mem_chunk **)((ch) + 1))
+
+static struct tcache
+{
+	long owner;		/* id of the thread, see __libc_thread_id() */
+	long pid;		/* its pid, to find out if it is gone */
+	struct mem_chunk *list[TCACHE_BINS];
+	unsigned char count[TCACHE_BINS];
+	/* calls served from the cache; only the owner writes them */
+	unsigned long mallocs, frees;
+} tcache[TCACHE_SLOTS];
+
+/* the cache of the calling thread, or NULL if it has none; only
+ * claiming a slot makes system calls
+ */
+static struct tcache *
+tcache_get(void)
+{
+	long self = __libc_thread_id();
+	struct tcache *tc = &tcache[(self / THREAD_STACKSIZE) % TCACHE_SLOTS];
+
+	if (tc->owner == self)
+		return tc;
+
+	/* claim the slot if it is unused or its thread is gone; the
+	 * chunks a dead thread left behind are taken over
+	 */
+	_mchunk_lock();
+	if (tc->owner == 0 || Pkill(tc->pid, 0) == -ESRCH)
+	{
+		tc->owner = self;
+		tc->pid = Pgetpid();
+	}
+	_mchunk_unlock();
+
+	return tc->owner == self ? tc : NULL;
+}
+
+/* add the calls that the caches served to *mallocs and *frees */
+void
+_mchunk_tcache_calls(unsigned long *mallocs, unsigned long *frees)
+{
+	int i;
+
+	for (i = 0; i < TCACHE_SLOTS; i++)
+	{
+		*mallocs += tcache[i].mallocs;
+		*frees += tcache[i].frees;
+	}
+}
+
+/* nonzero if the allocated chunk ch is the only one of a hunk of its
+ * own, from malloc_stram() or a big request; such a chunk goes back
+ * to the system when it is freed, it is never cached
+ */
+static int
+chunk_is_big(struct mem_chunk *ch)
+{
+	struct mem_chunk *s = NEXT_CHUNK(ch);
+
+	return s->valid == VAL_BORDER && (HUNK(FENCE_BORDER(s))->flags & HUNK_BIG);
+}
+
+
+void *
+__malloc(size_t n)
+{
+	struct tcache *tc;
+	struct mem_chunk *q;
+	unsigned long i;
+	void *r;
+
+	if (!__libc_threads)
+	{
+		_mchunk_stats.mallocs++;
+		return _mchunk_malloc(n);
+	}
+
+	i = (n + sizeof(struct mem_chunk) + (MALLOC_ALIGNMENT - 1)) / MALLOC_ALIGNMENT;
+	if (i < MIN_CHUNK / MALLOC_ALIGNMENT)
+		i = MIN_CHUNK / MALLOC_ALIGNMENT;
+	if (n < TCACHE_BINS * MALLOC_ALIGNMENT && i < TCACHE_BINS
+	    && (tc = tcache_get()) != NULL && tc->list[i] != NULL)
+	{
+		q = tc->list[i];
+		tc->list[i] = TCACHE_NEXT(q);
+		tc->count[i]--;
+		tc->mallocs++;
+		q->valid = VAL_ALLOC;
+		q++;
+		if (ZeroMallocs)
+			memset(q, 0, (i * MALLOC_ALIGNMENT) - sizeof(struct mem_chunk));
+		return (void *) q;
+	}
+
+	_mchunk_lock();
+	_mchunk_stats.mallocs++;
+	r = _mchunk_malloc(n);
+	_mchunk_unlock();
+
+	return r;
+}
+weak_alias(__malloc, malloc)
+
+void
+__free(void *param)
+{
+	struct mem_chunk *r = (struct mem_chunk *) param;
+	struct tcache *tc;
+	unsigned long i;
+
+	/* free(NULL) should do nothing */
+	if (r == NULL)
+		return;
+
+	if (!__libc_threads)
+	{
+		_mchunk_stats.frees++;
+		_mchunk_free(param);
+		return;
+	}
+
+	r--;
+	i = r->size / MALLOC_ALIGNMENT;
+	if (r->valid == VAL_ALLOC && i < TCACHE_BINS && !chunk_is_big(r)
+	    && (tc = tcache_get()) != NULL && tc->count[i] < TCACHE_DEPTH)
+	{
+		r->valid = VAL_CACHED;
+		TCACHE_NEXT(r) = tc->list[i];
+		tc->list[i] = r;
+		tc->count[i]++;
+		tc->frees++;
+		return;
+	}
+
+	_mchunk_lock();
+	_mchunk_stats.frees++;
+	_mchunk_free(param);
+	_mchunk_unlock();
 }
 weak_alias(__free, free)
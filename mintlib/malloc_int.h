@@ -2,18 +2,94 @@
 
 #define MALLOC_ALIGNMENT 8
 
-struct mem_chunk 
+struct mem_chunk
 {
 	long valid;
 #define VAL_FREE  0xf4ee0abcL
 #define VAL_ALLOC 0xa11c0abcL
 #define VAL_BORDER 0xb04d0abcL
+#define VAL_CACHED 0xcac40abcL
 
+	/* free chunks: next chunk in the same bin.
+	 * allocated chunks and fences: the free chunk immediately
+	 * below this one in memory, or NULL.  Since free neighbours are
+	 * always merged, this is all free() needs to find them.
+	 */
 	struct mem_chunk *next;
 	unsigned long size;
 };
-#define ALLOC_SIZE(ch) (*(long *)((char *)(ch) + sizeof(*(ch))))
-#define BORDER_EXTRA ((sizeof(struct mem_chunk) + sizeof(long) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1))
 
-/* linked list of free blocks */
-extern struct mem_chunk _mchunk_free_list;
+/* chunk following ch in memory */
+#define NEXT_CHUNK(ch) ((struct mem_chunk *)((char *)(ch) + (ch)->size))
+
+/* free chunks keep the back link of their bin in the user data */
+#define BIN_PREV(ch) (*(struct mem_chunk **)((char *)(ch) + sizeof(struct mem_chunk)))
+
+/* smallest chunk that can be put on the free list */
+#define MIN_CHUNK ((sizeof(struct mem_chunk) + sizeof(struct mem_chunk *) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1))
+
+/* Every hunk obtained from the system starts with a border chunk and
+ * ends with a fence; both are marked VAL_BORDER.  The border chunk
+ * links the hunk into _mchunk_hunk_list, the fence points back to it.
+ */
+struct mem_hunk
+{
+	unsigned long size;		/* bytes following the border chunk */
+	struct mem_chunk *prev;		/* previous hunk in the list */
+	long flags;
+#define HUNK_HEAP 1			/* carved from _heapbase */
+#define HUNK_BIG 2			/* Malloc'ed for a single big request */
+};
+#define HUNK(ch) ((struct mem_hunk *)((char *)(ch) + sizeof(struct mem_chunk)))
+#define ALLOC_SIZE(ch) (HUNK(ch)->size)
+#define BORDER_EXTRA ((sizeof(struct mem_chunk) + sizeof(struct mem_hunk) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1))
+
+#define FENCE_BORDER(ch) (*(struct mem_chunk **)((char *)(ch) + sizeof(struct mem_chunk)))
+#define FENCE_EXTRA ((sizeof(struct mem_chunk) + sizeof(struct mem_chunk *) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1))
+
+/* size-class bins: exact sizes below SMALLBIN_LIMIT,
+ * power-of-two ranges above
+ */
+#define NSMALLBINS 64
+#define SMALLBIN_LIMIT (NSMALLBINS * MALLOC_ALIGNMENT)
+#define NBINS (NSMALLBINS + 32)
+#define BINMAP_BITS (8 * sizeof(unsigned long))
+#define BINMAP_WORDS ((NBINS + BINMAP_BITS - 1) / BINMAP_BITS)
+
+/* linked list of hunks, through their border chunks */
+extern struct mem_chunk _mchunk_hunk_list;
+
+/* bin heads, and a bitmap of the bins that are not empty */
+extern struct mem_chunk *_mchunk_bins[NBINS];
+extern unsigned long _mchunk_binmap[BINMAP_WORDS];
+
+void _mchunk_bin_insert(struct mem_chunk *ch);
+void _mchunk_bin_remove(struct mem_chunk *ch);
+
+/* malloc and free without locking or per-thread caches */
+void *_mchunk_malloc(size_t n);
+void _mchunk_free(void *r);
+
+/* the heap lock, needed once tfork() has started a thread */
+void _mchunk_lock(void);
+void _mchunk_unlock(void);
+#define MALLOC_LOCK() do { if (__libc_threads) _mchunk_lock(); } while (0)
+#define MALLOC_UNLOCK() do { if (__libc_threads) _mchunk_unlock(); } while (0)
+
+/* grow an allocated chunk at the top of the heap in place */
+int _mchunk_extend_top(struct mem_chunk *ch, unsigned long n);
+
+/* counters for mallinfo() and friends */
+struct mem_stats
+{
+	unsigned long sbrk_bytes;	/* obtained through __sbrk */
+	unsigned long mxalloc_bytes;	/* Mxalloc'ed for the heap */
+	unsigned long big_bytes;	/* Malloc'ed for big requests */
+	unsigned long mallocs;
+	unsigned long frees;
+	unsigned long reallocs;
+};
+extern struct mem_stats _mchunk_stats;
+
+/* calls served by the per-thread caches, which are not counted above */
+void _mchunk_tcache_calls(unsigned long *mallocs, unsigned long *frees);
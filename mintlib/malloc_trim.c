@@ -0,0 +1,78 @@
+/* malloc_trim: give free memory at the end of hunks back to the system */
+
+#include <stddef.h>	/* for size_t */
+#include <stdlib.h>
+#include <malloc.h>
+#include <osbind.h>
+#include "lib.h"
+#include "malloc_int.h"
+
+
+/* Hunks that were Malloc'ed are shrunk with Mshrink so that at most
+ * pad bytes of their trailing free chunk are kept.  Hunks carved from
+ * _heapbase are already handed back to the heap by free() when their
+ * top becomes free, and completely free hunks are released right away.
+ * Returns 1 if any memory was released, 0 otherwise.
+ */
+__typeof__(malloc_trim) __malloc_trim;
+
+int
+__malloc_trim(size_t pad)
+{
+	struct mem_chunk *b, *q, *f;
+	unsigned long release;
+	int released = 0;
+
+	pad = (pad + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1);
+
+	MALLOC_LOCK();
+
+	for (b = _mchunk_hunk_list.next; b; b = b->next)
+	{
+		if (HUNK(b)->flags & HUNK_HEAP)
+			continue;
+
+		f = (struct mem_chunk *) ((char *) b + BORDER_EXTRA + ALLOC_SIZE(b) - FENCE_EXTRA);
+		q = f->next;
+		if (q == NULL || q->size <= pad
+		    || (char *) q == (char *) b + BORDER_EXTRA)
+			continue;
+
+		release = q->size - pad;
+		if (pad != 0 && pad < MIN_CHUNK)
+			release = q->size - MIN_CHUNK;
+		if (release < MIN_CHUNK)
+			continue;
+
+		_mchunk_bin_remove(q);
+		if (Mshrink(b, BORDER_EXTRA + ALLOC_SIZE(b) - release) != 0)
+		{
+			_mchunk_bin_insert(q);
+			continue;
+		}
+
+		ALLOC_SIZE(b) -= release;
+		if (release == q->size)
+		{
+			f = q;
+			f->next = NULL;
+		}
+		else
+		{
+			q->size -= release;
+			_mchunk_bin_insert(q);
+			f = NEXT_CHUNK(q);
+			f->next = q;
+		}
+		f->valid = VAL_BORDER;
+		f->size = FENCE_EXTRA;
+		FENCE_BORDER(f) = b;
+
+		released = 1;
+	}
+
+	MALLOC_UNLOCK();
+
+	return released;
+}
+weak_alias(__malloc_trim, malloc_trim)
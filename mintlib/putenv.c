@@ -4,64 +4,27 @@
 #include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
+#include <alloca.h>
 #include "lib.h"
 
 
-static void
-del_env(const char *strng)
-{
-	char **var;
-	char *name;
-	size_t len = 0;
-
-	if (!environ) return;
-
-/* find the length of "tag" in "tag=value" */
-	for (name = (char *)strng; *name && (*name != '='); name++)
-		len++;
-
-/* find the tag in the environment */
-	for (var = environ; (name = *var) != NULL; var++) {
-		if (!strncmp(name, strng, len) && name[len] == '=')
-			break;
-	}
-
-/* if it's found, move all the other environment variables down by 1 to
-   delete it
- */
-	if (name) {
-		while (name) {
-			name = var[1];
-			*var++ = name;
-		}
-	}
-}
-
 int
 putenv(const char *strng)
 {
-	int i = 0;
-	char **e;
+	const char *eq = strchr(strng, '=');
+	char *name;
 
-	del_env(strng);
+	/* without a value, just remove the variable */
+	if (eq == NULL)
+		return unsetenv(strng);
 
-	if (!environ)
-		e = malloc(2*sizeof(char *));
-	else {
-		while(environ[i]) i++ ;
-		e = malloc((i+2)*sizeof(char *));
-		if (!e) {
-			return -1;
-		}
-		memcpy(e, environ, (i+1)*sizeof(char *));
-		free(environ);
-		environ = e;
-	}
-	if (!e)
-		return -1;
+	/* the string itself goes into the environment, replacing an
+	 * existing entry for the same name in place; setenv.c keeps
+	 * spare slots, so adding one is cheap
+	 */
+	name = alloca(eq - strng + 1);
+	memcpy(name, strng, eq - strng);
+	name[eq - strng] = '\0';
 
-	environ = e;
-	environ[i] = (char *)strng;
-	environ[i+1] = 0;
-	return 0;
+	return __add_to_environ(name, NULL, strng, 1);
 }
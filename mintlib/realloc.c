@@ -13,85 +13,89 @@
 #include "malloc_int.h"
 
 
-void *
-__realloc (void *r, size_t n)
+/* resize the block at r, with the heap locked */
+static void *
+resize (void *r, size_t n)
 {
 	struct mem_chunk *p;
-	long sz;
-
-	/* obscure features:
-	 * 
-	 * realloc(NULL,n) is the same as malloc(n)
-	 * realloc(p, 0) is the same as free(p)
-	 */
-	if (!r)
-		return __malloc(n);
-
-	if (n == 0) {
-		__free(r);
-		return NULL;
-	}
+	unsigned long sz;
 
 	p = ((struct mem_chunk *) r) - 1;
 	sz = (n + sizeof(struct mem_chunk) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1);
+	if (sz < MIN_CHUNK)
+		sz = MIN_CHUNK;
 
-	if (p->size > (sz + ((2 * sizeof(struct mem_chunk) + (MALLOC_ALIGNMENT - 1)) & ~(MALLOC_ALIGNMENT - 1))))
+	if (p->size < sz)
 	{
-		/* resize down */
-		void *newr;
-
-		newr = __malloc(n);
-		if (newr)
-		{
-			memcpy(newr, r, n);
-			__free(r);
-
-			r = newr;
-		}
-		/* else
-		 * malloc failed; can be safely ignored as the new block
-		 * is smaller
-		 */
-	}
-	else if (p->size < sz)
-	{
-		/* block too small, get new one */
-		struct mem_chunk *q, *s, *t;
-
-		q = &_mchunk_free_list;
-		t = _mchunk_free_list.next;
-		while (t && t < p)
-		{
-			q = t;
-			t = t->next;
-		}
+		/* block too small, try to grow it in place */
+		struct mem_chunk *t;
 
 		/* merge after if possible */
-		s = (struct mem_chunk * )(((long) p) + p->size);
-		if (t && s >= t && p->size + t->size >= sz
-		    && t->valid != VAL_BORDER)
+		t = NEXT_CHUNK(p);
+		if (t->valid == VAL_FREE && p->size + t->size >= sz)
 		{
-			assert(s == t);
-
+			_mchunk_bin_remove(t);
 			p->size += t->size;
-			q->next = t->next;
 			t->size = 0;
 			t->next = NULL;
+			NEXT_CHUNK(p)->next = NULL;
 		}
-		else
+		/* or extend the top of the heap */
+		else if (!_mchunk_extend_top(p, sz - p->size))
 		{
 			void *newr;
 
-			newr = __malloc(n);
+			newr = _mchunk_malloc(n);
 			if (newr)
 			{
 				memcpy(newr, r, p->size - sizeof(struct mem_chunk));
-				__free(r);
+				_mchunk_free(r);
 			}
-			r = newr;
+			return newr;
 		}
 	}
 
+	if (p->size >= sz + MIN_CHUNK)
+	{
+		/* resize down: split off the tail and free it, which
+		 * merges it with a free chunk following it
+		 */
+		struct mem_chunk *t;
+
+		t = (struct mem_chunk *) ((char *) p + sz);
+		t->valid = VAL_ALLOC;
+		t->size = p->size - sz;
+		t->next = NULL;
+		p->size = sz;
+		_mchunk_free(t + 1);
+	}
+
 	return (void *) r;
 }
+
+
+void *
+__realloc (void *r, size_t n)
+{
+	/* obscure features:
+	 * 
+	 * realloc(NULL,n) is the same as malloc(n)
+	 * realloc(p, 0) is the same as free(p)
+	 */
+	if (!r)
+		return __malloc(n);
+
+	MALLOC_LOCK();
+	_mchunk_stats.reallocs++;
+	if (n == 0) {
+		MALLOC_UNLOCK();
+		__free(r);
+		return NULL;
+	}
+
+	r = resize(r, n);
+	MALLOC_UNLOCK();
+
+	return r;
+}
 weak_alias (__realloc, realloc)
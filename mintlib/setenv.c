@@ -40,6 +40,7 @@ extern int errno;
 #define __environ	environ
 
 #if _LIBC
+# include "lib.h"
 # define LOCK
 # define UNLOCK
 #endif
@@ -62,6 +63,9 @@ __typeof__(clearenv) __clearenv;
    environment.  */
 static char **last_environ;
 
+/* Number of slots allocated in last_environ.  */
+static size_t last_environ_size;
+
 
 /* This function is used by `setenv' and `putenv'.  The difference between
    the two functions is that for the former must create a new string which
@@ -69,7 +73,7 @@ static char **last_environ;
    must be used directly.  This is all complicated by the fact that we try
    to reuse values once generated for a `setenv' call since we can never
    free the strings.  */
-static int
+int
 __add_to_environ (const char *name, const char *value, const char *combined, int replace)
 {
   register char **ep;
@@ -95,15 +99,24 @@ __add_to_environ (const char *name, const char *value, const char *combined, int
 
   if (ep == NULL || __builtin_expect (*ep == NULL, 1))
     {
-      char **new_environ;
+      char **new_environ = last_environ;
 
-      /* We allocated this space; we can extend it.  */
-      new_environ = (char **) realloc (last_environ,
-				       (size + 2) * sizeof (char *));
-      if (new_environ == NULL)
+      /* We allocated this space; we can extend it.  It grows by half
+	 its size at a time, so adding many variables is not quadratic.  */
+      if (__environ != last_environ || size + 2 > last_environ_size)
 	{
-	  UNLOCK;
-	  return -1;
+	  size_t new_size = size + 2;
+
+	  if (__environ == last_environ)
+	    new_size += new_size / 2;
+	  new_environ = (char **) realloc (last_environ,
+					   new_size * sizeof (char *));
+	  if (new_environ == NULL)
+	    {
+	      UNLOCK;
+	      return -1;
+	    }
+	  last_environ_size = new_size;
 	}
 
       /* If the whole entry is given add it.  */
@@ -162,6 +175,7 @@ __add_to_environ (const char *name, const char *value, const char *combined, int
       new_environ[size + 1] = NULL;
 
       last_environ = __environ = new_environ;
+      ++__libc_environ_gen;
     }
   else if (replace)
     {
@@ -211,6 +225,7 @@ __add_to_environ (const char *name, const char *value, const char *combined, int
 	}
 
       *ep = np;
+      ++__libc_environ_gen;
     }
 
   UNLOCK;
@@ -258,6 +273,7 @@ int unsetenv (const char *name)
 	  do
 	    dp[0] = dp[1];
 	  while (*dp++);
+	  ++__libc_environ_gen;
 	  /* Continue the loop in case NAME appears again.  */
 	}
       else
@@ -281,10 +297,12 @@ int clearenv (void)
       /* We allocated this environment so we can free it.  */
       free (__environ);
       last_environ = NULL;
+      last_environ_size = 0;
     }
 
   /* Clear the environment pointer removes the whole environment.  */
   __environ = NULL;
+  ++__libc_environ_gen;
 
   UNLOCK;
 
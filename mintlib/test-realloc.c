@@ -0,0 +1,154 @@
+/* Grow buffers with realloc, the way string builders and getdelim do,
+   and report how many bytes had to be copied because a block moved.
+   Check that a block grows into a free neighbour without moving and
+   that shrinking gives the tail back.  */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LIMIT (256 * 1024L)
+
+static int
+grow (const char *what, int linear)
+{
+  char *buf = NULL;
+  size_t size = 0, used = 0, i;
+  unsigned long copied = 0, moves = 0, calls = 0;
+  clock_t start = clock ();
+
+  while (used < LIMIT)
+    {
+      if (used == size)
+	{
+	  size_t nsize = linear ? size + 64 : (size ? 2 * size : 16);
+	  char *nbuf = realloc (buf, nsize);
+
+	  if (nbuf == NULL)
+	    {
+	      printf ("FAIL: %s: out of memory at %lu bytes\n", what,
+		      (unsigned long) nsize);
+	      free (buf);
+	      return 1;
+	    }
+	  if (buf != NULL && nbuf != buf)
+	    {
+	      copied += used;
+	      moves++;
+	    }
+	  calls++;
+	  buf = nbuf;
+	  size = nsize;
+	}
+      buf[used] = (char) used;
+      used++;
+    }
+
+  for (i = 0; i < used; i++)
+    if (buf[i] != (char) i)
+      {
+	printf ("FAIL: %s: contents lost at offset %lu\n", what,
+		(unsigned long) i);
+	free (buf);
+	return 1;
+      }
+
+  /* shrink it again, keeping the head */
+  buf = realloc (buf, 100);
+  for (i = 0; i < 100; i++)
+    if (buf[i] != (char) i)
+      {
+	printf ("FAIL: %s: contents lost after shrinking\n", what);
+	free (buf);
+	return 1;
+      }
+  free (buf);
+
+  printf ("%s: %lu reallocs, %lu moves, %lu bytes copied, %ld ticks\n",
+	  what, calls, moves, copied, (long) (clock () - start));
+  return 0;
+}
+
+static int
+in_place (void)
+{
+  char *a, *b, *guard, *na;
+  struct mallinfo before, after;
+  int i;
+
+  a = malloc (64);
+  b = malloc (512);
+  guard = malloc (64);
+  if (a == NULL || b == NULL || guard == NULL)
+    {
+      puts ("FAIL: in place: out of memory");
+      return 1;
+    }
+  for (i = 0; i < 64; i++)
+    a[i] = (char) i;
+
+  /* B follows A, so A can take its room once it is free.  */
+  if (b > a && b < a + 64 + 64)
+    {
+      free (b);
+      b = NULL;
+      na = realloc (a, 400);
+      if (na != a)
+	{
+	  puts ("FAIL: in place: block moved although its neighbour was free");
+	  return 1;
+	}
+      a = na;
+      for (i = 0; i < 64; i++)
+	if (a[i] != (char) i)
+	  {
+	    puts ("FAIL: in place: contents lost when growing");
+	    return 1;
+	  }
+    }
+  else
+    puts ("in place: blocks not adjacent, growth not checked");
+
+  /* The tail of a shrunk block is free again.  */
+  before = mallinfo ();
+  na = realloc (a, 16);
+  after = mallinfo ();
+  if (na != a)
+    {
+      puts ("FAIL: in place: block moved when shrinking");
+      return 1;
+    }
+  a = na;
+  if (a[0] != 0 || a[15] != 15)
+    {
+      puts ("FAIL: in place: contents lost when shrinking");
+      return 1;
+    }
+  if (after.fordblks < before.fordblks + 64)
+    {
+      printf ("FAIL: in place: shrinking freed %d bytes\n",
+	      (int) (after.fordblks - before.fordblks));
+      return 1;
+    }
+
+  free (a);
+  free (b);
+  free (guard);
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result = 0;
+
+  result |= in_place ();
+
+  result |= grow ("geometric", 0);
+  result |= grow ("linear", 1);
+
+  if (result == 0)
+    puts ("PASS: realloc grows buffers");
+  return result;
+}
@@ -10,7 +10,8 @@
  *  this behavior)
  *
  * Note that parent and child share the same memory; this could cause
- * problems with some library calls, notably malloc().
+ * problems with some library calls.  malloc() and friends start locking
+ * the heap once the first thread is running.
  */
 
 #include <compiler.h>
@@ -24,8 +25,6 @@
 #include <support.h>
 #include "lib.h"
 
-#define THREAD_STACKSIZE 4096L
-
 
 /* this is used by wait() and wait3() to retrieve the child's exit code */
 long __waitval = -ENOENT;
@@ -75,6 +74,7 @@ long
 tfork(int (*func)(long), long arg)
 {
 	BASEPAGE *b;
+	long *stack;
 	long pid;
 	long savpending, savmask;
 	sighandler_t savhandler[NSIG];
@@ -85,13 +85,23 @@ tfork(int (*func)(long), long arg)
 	b = (BASEPAGE *)Pexec(PE_CBASEPAGE, 0L, "", 0L);
 	if ((long)b <= 0)
 		return (long)b;
-	(void)Mshrink(b, stacksize + sizeof(*b));
+
+	/* the stack goes at the first boundary of its size above the
+	 * basepage, see __libc_thread_id()
+	 */
+	stack = (long *)(((long)(b + 1) + stacksize - 1) & ~(stacksize - 1));
+	(void)Mshrink(b, (char *)stack + stacksize - (char *)b);
+	stack[0] = THREAD_MAGIC;
+	stack[1] = (long)stack;
 	b->p_tbase = (char *)startup;
 	b->p_dbase = (char *)func;
 	b->p_dlen = arg;
 	b->p_blen = stacksize;
-	b->p_hitpa = ((char *)b) + stacksize + sizeof(*b);
+	b->p_hitpa = (char *)stack + stacksize;
 
+	/* without MiNT the child runs to completion before we go on */
+	if (__mint)
+		__libc_threads = 1;
 	pid = Pexec(PE_ASYNC_GO, 0L, b, 0L);
 	if (pid == -ENOSYS)
 	{
@@ -367,6 +367,17 @@ _itoa (unsigned long long int value, CHAR_T *buflim, unsigned int base, int uppe
 	    mp_limb_t ti = t[--n];
 	    int ndig_for_this_limb = 0;
 
+	    if (base == 10)
+	      {
+		/* the limbs are below 10^9; _itoa_dec needs no division */
+		CHAR_T *start = bp;
+
+		if (ti != 0)
+		  bp = _itoa_dec (ti, bp);
+		ndig_for_this_limb = start - bp;
+	      }
+	    else
+	      {
 #if UDIV_TIME > 2 * UMUL_TIME
 	    mp_limb_t base_multiplier = brec->base_multiplier;
 	    if (brec->flag)
@@ -405,6 +416,7 @@ _itoa (unsigned long long int value, CHAR_T *buflim, unsigned int base, int uppe
 		++ndig_for_this_limb;
 	      }
 #endif
+	      }
 	    /* If this wasn't the most significant word, pad with zeros.  */
 	    if (n != 0)
 	      while (ndig_for_this_limb < brec->big.ndigits)
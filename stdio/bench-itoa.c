@@ -0,0 +1,123 @@
+/* Benchmark for the integer conversions of printf: formats a million
+   integers of every size with each of the conversions below and prints
+   the number of conversions per second.
+
+   Usage: bench-itoa [-n count]
+
+   The values are spread over all magnitudes, so that short and long
+   numbers are converted equally often.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <support.h>
+#include <time.h>
+
+static unsigned long count = 1000000L;
+
+/* the same pseudo random numbers everywhere */
+static unsigned long seed;
+
+static unsigned long
+rnd (void)
+{
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  return seed;
+}
+
+/* a random value of a random number of bits */
+static unsigned long long
+value (int bits)
+{
+  unsigned long long v = ((unsigned long long) rnd () << 32) | rnd ();
+  int n = rnd () % bits + 1;
+
+  return n < 64 ? v & ((1ULL << n) - 1) : v;
+}
+
+enum { D, U, LU, X, LLU, LTOA, FPRINTF };
+static const char *const names[] =
+  { "%d", "%u", "%lu", "%x", "%llu", "_ltoa", "fprintf %lu" };
+
+static unsigned long
+run (int what, FILE *fp)
+{
+  char buf[32];
+  unsigned long i, sum = 0;
+
+  for (i = 0; i < count; i++)
+    {
+      switch (what)
+	{
+	case D:
+	  sprintf (buf, "%d", (int) value (32));
+	  break;
+	case U:
+	  sprintf (buf, "%u", (unsigned int) value (32));
+	  break;
+	case LU:
+	  sprintf (buf, "%lu", (unsigned long) value (32));
+	  break;
+	case X:
+	  sprintf (buf, "%x", (unsigned int) value (32));
+	  break;
+	case LLU:
+	  sprintf (buf, "%llu", value (64));
+	  break;
+	case LTOA:
+	  _ltoa ((long) value (32), buf, 10);
+	  break;
+	case FPRINTF:
+	  fprintf (fp, "%lu\n", (unsigned long) value (32));
+	  buf[0] = '0';
+	  break;
+	}
+      sum += buf[0];
+    }
+  return sum;
+}
+
+int
+main (int argc, char *argv[])
+{
+  FILE *fp;
+  clock_t start, used;
+  unsigned long sum = 0;
+  int what;
+  char buf[32];
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    count = strtoul (argv[2], NULL, 10);
+
+  /* a quick check that the conversions work at all */
+  sprintf (buf, "%lu %lld", 4294967295UL, -9223372036854775807LL - 1);
+  if (strcmp (buf, "4294967295 -9223372036854775808") != 0)
+    {
+      printf ("bench-itoa: printf is broken: %s\n", buf);
+      return 1;
+    }
+
+  fp = tmpfile ();
+  if (fp == NULL)
+    {
+      perror ("bench-itoa: tmpfile");
+      return 1;
+    }
+
+  for (what = D; what <= FPRINTF; what++)
+    {
+      seed = 1;
+      start = clock ();
+      sum += run (what, fp);
+      used = clock () - start;
+      if (used == 0)
+	used = 1;
+      printf ("%-12s %8lu in %6.2f s %10.0f/s\n", names[what], count,
+	      (double) used / CLOCKS_PER_SEC,
+	      (double) count * CLOCKS_PER_SEC / used);
+      rewind (fp);
+    }
+
+  fclose (fp);
+  return sum == 0;
+}
@@ -20,12 +20,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include "lib.h"
 
 
 /* Close a stream.  */
 int
 fclose (FILE *stream)
 {
+  struct __stdio_lock *lock;
   int status;
 
   if (!__validfp (stream))
@@ -34,10 +36,16 @@ fclose (FILE *stream)
       return EOF;
     }
 
+  __STDIO_LOCK (stream);
+  lock = stream->__lock;
+
   if (stream->__mode.__write &&
       /* Flush the buffer.  */
       __flshfp (stream, EOF) == EOF)
-    return EOF;
+    {
+      __STDIO_UNLOCK (stream);
+      return EOF;
+    }
 
   /* Free the buffer's storage.  */
   if (stream->__buffer != NULL && !stream->__userbuf)
@@ -51,8 +59,12 @@ fclose (FILE *stream)
   else
     status = 0;
 
-  /* Nuke the stream, making it available for re-use.  */
+  /* Nuke the stream, making it available for re-use.  It keeps its
+     lock, which is released only now: a thread that was waiting for
+     it finds the stream closed.  */
   __invalidate (stream);
+  if (__libc_threads)
+    __stdio_unlock (lock);
 
   return status < 0 ? EOF : 0;
 }
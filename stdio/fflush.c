@@ -18,11 +18,12 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "lib.h"
 
-/* Flush STREAM's buffer.
+/* Flush STREAM's buffer without locking it.
    If STREAM is NULL, flush the buffers of all streams that are writing.  */
 int
-fflush (FILE *stream)
+fflush_unlocked (FILE *stream)
 {
   if (stream == NULL)
     {
@@ -46,4 +47,15 @@ fflush (FILE *stream)
 
   return __flshfp (stream, EOF);
 }
-weak_alias(fflush, fflush_unlocked)
+/* Flush STREAM's buffer.
+   If STREAM is NULL, flush the buffers of all streams that are writing.  */
+int
+fflush (FILE *stream)
+{
+  int result;
+
+  __STDIO_LOCK (stream);
+  result = fflush_unlocked (stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
@@ -19,11 +19,12 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include "lib.h"
 
 
-/* Read a character from STREAM.  */
+/* Read a character from STREAM without locking it.  */
 int
-fgetc (FILE *stream)
+fgetc_unlocked (FILE *stream)
 {
   if (!__validfp (stream) || !stream->__mode.__read)
     {
@@ -36,3 +37,15 @@ fgetc (FILE *stream)
 
   return __getc (stream);
 }
+
+/* Read a character from STREAM.  */
+int
+fgetc (FILE *stream)
+{
+  int c;
+
+  __STDIO_LOCK (stream);
+  c = fgetc_unlocked (stream);
+  __STDIO_UNLOCK (stream);
+  return c;
+}
@@ -20,6 +20,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include "lib.h"
 
 extern void* __memccpy (void*, const void*, int, size_t);
 
@@ -28,9 +29,10 @@ extern void* __memccpy (void*, const void*, int, size_t);
    the newline, unlike gets.  Finishes by appending a null character and
    returning S.  If EOF is seen before any characters have been written
    to S, the function returns NULL without appending the null character.
-   If there is a file error, always return NULL.  */
+   If there is a file error, always return NULL.  This one does not
+   lock STREAM.  */
 char *
-fgets (char *s, int n, FILE *stream)
+fgets_unlocked (char *s, int n, FILE *stream)
 {
   register char *p = s;
 
@@ -47,7 +49,7 @@ fgets (char *s, int n, FILE *stream)
     {
       /* Unbuffered stream.  Not much optimization to do.  */
       register int c = 0;
-      while (--n > 0 && (c = getc (stream)) != EOF)
+      while (--n > 0 && (c = __getc (stream)) != EOF)
 	if ((*p++ = c) == '\n')
 	  break;
       if (c == EOF && (p == s || ferror (stream)))
@@ -63,7 +65,7 @@ fgets (char *s, int n, FILE *stream)
       (!stream->__seen || stream->__buffer == NULL || stream->__pushed_back))
     {
       /* Do one with getc to allocate a buffer.  */
-      int c = getc (stream);
+      int c = __getc (stream);
       if (c == EOF)
 	return NULL;
       *p++ = c;
@@ -122,4 +124,14 @@ fgets (char *s, int n, FILE *stream)
   return ferror (stream) ? NULL : s;
 }
 
-weak_alias (fgets, fgets_unlocked)
+/* The same with STREAM locked.  */
+char *
+fgets (char *s, int n, FILE *stream)
+{
+  char *result;
+
+  __STDIO_LOCK (stream);
+  result = fgets_unlocked (s, n, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
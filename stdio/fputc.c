@@ -19,14 +19,15 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include "lib.h"
 
 #if __GNUC_PREREQ(7, 0)
 # pragma GCC diagnostic ignored "-Wnonnull-compare"
 #endif
 
-/* Write the character C to STREAM.  */
+/* Write the character C to STREAM without locking it.  */
 int
-fputc (int c, FILE *stream)
+fputc_unlocked (int c, FILE *stream)
 {
   if (!__validfp (stream) || !stream->__mode.__write)
     {
@@ -40,6 +41,14 @@ fputc (int c, FILE *stream)
   return __putc (c, stream);
 }
 
-#ifndef fputc
-weak_alias (fputc, fputc_unlocked)
-#endif
+/* Write the character C to STREAM.  */
+int
+fputc (int c, FILE *stream)
+{
+  int result;
+
+  __STDIO_LOCK (stream);
+  result = fputc_unlocked (c, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
@@ -20,20 +20,32 @@
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include "lib.h"
 
 #ifdef fputs_unlocked
 # undef fputs_unlocked
 #endif
 
-/* Write the string S to STREAM.  */
+/* Write the string S to STREAM without locking it.  */
 int
-fputs (const char *s, FILE *stream)
+fputs_unlocked (const char *s, FILE *stream)
 {
   const size_t len = strlen (s);
   if (len == 1)
-    return putc (*s, stream) == EOF ? EOF : 0;
-  if (fwrite ((void *) s, 1, len, stream) != len)
+    return __putc (*s, stream) == EOF ? EOF : 0;
+  if (fwrite_unlocked ((void *) s, 1, len, stream) != len)
     return EOF;
   return 0;
 }
-weak_alias (fputs, fputs_unlocked)
+
+/* Write the string S to STREAM.  */
+int
+fputs (const char *s, FILE *stream)
+{
+  int result;
+
+  __STDIO_LOCK (stream);
+  result = fputs_unlocked (s, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
@@ -18,13 +18,15 @@
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include "lib.h"
 
 
 #define	default_func	__default_room_functions.__input
 
-/* Read NMEMB chunks of SIZE bytes each from STREAM into P.  */
+/* Read NMEMB chunks of SIZE bytes each from STREAM into P without
+   locking STREAM.  */
 size_t
-fread (void *p, size_t size, size_t nmemb, FILE *stream)
+fread_unlocked (void *p, size_t size, size_t nmemb, FILE *stream)
 {
   register char *ptr = (char *) p;
   register size_t to_read = size * nmemb;
@@ -127,4 +129,14 @@ fread (void *p, size_t size, size_t nmemb, FILE *stream)
   return (bytes - to_read) / size;
 }
 
-weak_alias (fread, fread_unlocked)
+/* Read NMEMB chunks of SIZE bytes each from STREAM into P.  */
+size_t
+fread (void *p, size_t size, size_t nmemb, FILE *stream)
+{
+  size_t result;
+
+  __STDIO_LOCK (stream);
+  result = fread_unlocked (p, size, nmemb, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
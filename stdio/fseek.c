@@ -17,16 +17,18 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include "lib.h"
 
 
 /* Move the file position of STREAM to OFFSET
    bytes from the beginning of the file if WHENCE
    is SEEK_SET, the end of the file is it is SEEK_END,
-   or the current position if it is SEEK_CUR.  */
-int
-fseek (FILE *stream, long int offset, int whence)
+   or the current position if it is SEEK_CUR.
+   The caller has locked STREAM.  */
+static int
+seek (FILE *stream, off_t offset, int whence)
 {
-  long int o;
+  off_t o;
 
   if (!__validfp (stream))
     {
@@ -34,6 +36,32 @@ fseek (FILE *stream, long int offset, int whence)
       return EOF;
     }
 
+  /* If nothing was written into the buffer, the data read into it is
+     that of the file from the target position on.  A position within
+     that data is reached by moving bufp, without a system call and
+     without reading the data again.  */
+  if (stream->__buffer != NULL
+      && stream->__put_limit == stream->__buffer
+      && !stream->__linebuf_active
+      && stream->__target != (fpos_t) -1
+      && stream->__io_funcs.__seek != NULL
+      && (whence == SEEK_SET || whence == SEEK_CUR))
+    {
+      o = offset;
+      if (whence == SEEK_CUR)
+	o += stream->__target
+	     + ((stream->__pushed_back ? stream->__pushback_bufp
+		 : stream->__bufp) - stream->__buffer);
+      if (o >= stream->__target
+	  && o - stream->__target <= stream->__get_limit - stream->__buffer)
+	{
+	  stream->__pushed_back = 0;
+	  stream->__bufp = stream->__buffer + (o - stream->__target);
+	  stream->__eof = 0;
+	  return 0;
+	}
+    }
+
   /* Write out any pending data.  */
   if (stream->__mode.__write && __flshfp (stream, EOF) == EOF)
     return EOF;
@@ -146,9 +174,24 @@ fseek (FILE *stream, long int offset, int whence)
   return 0;
 }
 
-/* Just use fseek for now */
 int
 fseeko (FILE *stream, off_t offset, int whence)
 {
-  return fseek(stream, offset, whence);
+  int result;
+
+  __STDIO_LOCK (stream);
+  result = seek (stream, offset, whence);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
+
+int
+fseek (FILE *stream, long int offset, int whence)
+{
+  if ((off_t) offset != offset)
+    {
+      __set_errno (EOVERFLOW);
+      return EOF;
+    }
+  return fseeko (stream, (off_t) offset, whence);
 }
@@ -17,13 +17,15 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include "lib.h"
 
 /* Return the offset in bytes from the beginning
-   of the file of the file position of STREAM.  */
-long int
-ftell (FILE *stream)
+   of the file of the file position of STREAM.
+   The caller has locked STREAM.  */
+static off_t
+tell (FILE *stream)
 {
-  long int pos;
+  off_t pos;
 
   if (!__validfp (stream))
     {
@@ -51,9 +53,26 @@ ftell (FILE *stream)
   return pos;
 }
 
-/* Just use ftell for now */
 off_t
 ftello (FILE *stream)
 {
-  return ftell(stream);
+  off_t pos;
+
+  __STDIO_LOCK (stream);
+  pos = tell (stream);
+  __STDIO_UNLOCK (stream);
+  return pos;
+}
+
+long int
+ftell (FILE *stream)
+{
+  off_t pos = ftello (stream);
+
+  if ((long int) pos != pos)
+    {
+      __set_errno (EOVERFLOW);
+      return -1L;
+    }
+  return pos;
 }
@@ -18,15 +18,17 @@
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include "lib.h"
 
 
 #if __GNUC_PREREQ(7, 0)
 # pragma GCC diagnostic ignored "-Wnonnull-compare"
 #endif
 
-/* Write NMEMB chunks of SIZE bytes each from PTR onto STREAM.  */
+/* Write NMEMB chunks of SIZE bytes each from PTR onto STREAM without
+   locking STREAM.  */
 size_t
-fwrite (const void *ptr, size_t size, size_t nmemb, FILE *stream)
+fwrite_unlocked (const void *ptr, size_t size, size_t nmemb, FILE *stream)
 {
   register const unsigned char *p = (const unsigned char *) ptr;
   register size_t to_write = size * nmemb;
@@ -159,7 +161,7 @@ fwrite (const void *ptr, size_t size, size_t nmemb, FILE *stream)
 	  else if (buffer_space == 0)
 	    {
 	      /* We have filled the buffer, so flush it.  */
-	      if (fflush (stream) == EOF)
+	      if (fflush_unlocked (stream) == EOF)
 		break;
 
 	      /* Reset our record of the space available in the buffer,
@@ -185,7 +187,7 @@ fwrite (const void *ptr, size_t size, size_t nmemb, FILE *stream)
 	 line-buffered and just put a newline in the buffer, flush now to
 	 make sure it gets out.  */
       if (newlinep)
-	fflush (stream);
+	fflush_unlocked (stream);
     }
   else
     {
@@ -193,6 +195,20 @@ fwrite (const void *ptr, size_t size, size_t nmemb, FILE *stream)
 
       if (stream->__bufp != stream->__buffer)
 	{
+	  /* If the data is going to be written straight out after the
+	     buffer, try to write both with one system call.  */
+	  if (stream->__bufsize < to_write || newlinep)
+	    {
+	      ssize_t count = __stdio_gather_write (stream,
+						    (const char *) p,
+						    to_write);
+	      if (count >= 0)
+		{
+		  written += count;
+		  goto done;
+		}
+	    }
+
 	  /* There are characters in the buffer.  Flush them.  */
 	  if (__flshfp (stream, EOF) == EOF)
 	    goto done;
@@ -218,4 +234,14 @@ fwrite (const void *ptr, size_t size, size_t nmemb, FILE *stream)
   return (size_t) written / size;
 }
 
-weak_alias (fwrite, fwrite_unlocked)
+/* Write NMEMB chunks of SIZE bytes each from PTR onto STREAM.  */
+size_t
+fwrite (const void *ptr, size_t size, size_t nmemb, FILE *stream)
+{
+  size_t result;
+
+  __STDIO_LOCK (stream);
+  result = fwrite_unlocked (ptr, size, nmemb, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
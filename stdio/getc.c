@@ -1,6 +1,5 @@
 #include <stdio.h>
 #undef	getc
 #define	fgetc	getc
+#define	fgetc_unlocked	getc_unlocked
 #include "fgetc.c"
-
-weak_alias (getc, getc_unlocked)
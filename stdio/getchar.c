@@ -16,6 +16,7 @@
    <https://www.gnu.org/licenses/>.  */
 
 #include <stdio.h>
+#include "lib.h"
 
 #undef getchar
 
@@ -24,7 +25,17 @@
 int
 getchar (void)
 {
-  return __getc (stdin);
+  int c;
+
+  __STDIO_LOCK (stdin);
+  c = __getc (stdin);
+  __STDIO_UNLOCK (stdin);
+  return c;
 }
 
-weak_alias (getchar, getchar_unlocked)
+/* Read a character from stdin without locking it.  */
+int
+getchar_unlocked (void)
+{
+  return __getc (stdin);
+}
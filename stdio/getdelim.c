@@ -23,6 +23,7 @@
 #include <string.h>
 #include <limits.h>
 #include <errno.h>
+#include "lib.h"
 
 __typeof__(memccpy) __memccpy;
 
@@ -30,10 +31,11 @@ __typeof__(memccpy) __memccpy;
    (and null-terminate it). *LINEPTR is a pointer returned from malloc (or
    NULL), pointing to *N characters of space.  It is realloc'd as
    necessary.  Returns the number of characters read (not including the
-   null terminator), or -1 on error or EOF.  */
+   null terminator), or -1 on error or EOF.  The caller has locked
+   STREAM.  */
 
-ssize_t
-__getdelim (char **lineptr, size_t *n, int terminator, FILE *stream)
+static ssize_t
+getdelim_unlocked (char **lineptr, size_t *n, int terminator, FILE *stream)
 {
   char *line, *p;
   size_t size, copy;
@@ -76,7 +78,7 @@ __getdelim (char **lineptr, size_t *n, int terminator, FILE *stream)
 
 	  while (--copy > 0)
 	    {
-	      register int c = getc (stream);
+	      register int c = __getc (stream);
 	      if (c == EOF)
 		goto lose;
 	      else if ((*p++ = c) == terminator)
@@ -103,7 +105,7 @@ __getdelim (char **lineptr, size_t *n, int terminator, FILE *stream)
       if (!stream->__seen || stream->__buffer == NULL || stream->__pushed_back)
 	{
 	  /* Do one with getc to allocate a buffer.  */
-	  int c = getc (stream);
+	  int c = __getc (stream);
 	  if (c == EOF)
 	    goto lose;
 	  *p++ = c;
@@ -173,4 +175,15 @@ __getdelim (char **lineptr, size_t *n, int terminator, FILE *stream)
   return p - *lineptr;
 }
 
+ssize_t
+__getdelim (char **lineptr, size_t *n, int terminator, FILE *stream)
+{
+  ssize_t result;
+
+  __STDIO_LOCK (stream);
+  result = getdelim_unlocked (lineptr, n, terminator, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
+
 weak_alias (__getdelim, getdelim)
@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include "lib.h"
 
 link_warning (gets, "the `gets' function is dangerous and should not be used.")
 
@@ -36,10 +37,15 @@ gets (char *s)
       return NULL;
     }
 
+  __STDIO_LOCK (stream);
+
   if (feof (stream) || ferror (stream))
-    return NULL;
+    {
+      __STDIO_UNLOCK (stream);
+      return NULL;
+    }
 
-  while ((c = getchar ()) != EOF)
+  while ((c = __getc (stream)) != EOF)
     if (c == '\n')
       break;
     else
@@ -47,6 +53,8 @@ gets (char *s)
 
   *p = '\0';
 
+  __STDIO_UNLOCK (stream);
+
   /* Return null if we had an error, or if we got EOF
      before writing any characters.  */
 
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/uio.h>
 #include "lib.h"
 
 
@@ -61,7 +62,7 @@ init_stream (register FILE *fp)
       int save;
 
       if (fp->__bufsize == 0)
-	fp->__bufsize = BUFSIZ;
+	fp->__bufsize = __stdio_bufsize (fp);
 
       /* Try to get however many bytes of buffering __stdio_pickbuf
 	 specified, but if that much memory isn't available,
@@ -496,6 +497,8 @@ extern __io_write_fn __stdio_text_write;
 extern __io_seek_fn __stdio_seek;
 extern __io_close_fn __stdio_close;
 extern __io_fileno_fn __stdio_fileno;
+extern ssize_t __stdio_writev (void *cookie, const struct iovec *iov,
+			       int niov);
 const __io_functions __default_io_functions =
   {
     __stdio_read, __stdio_write, __stdio_seek, __stdio_close, __stdio_fileno
@@ -596,6 +599,85 @@ __flshfp (FILE *fp, int c)
 }
 
 
+/* Write out the buffer of FP and then the N bytes at P with a single
+   writev.  fwrite uses this for data that would go straight to the
+   file after the buffer was flushed, so that a pipe or socket gets one
+   packet instead of two.  Return the number of bytes of P written, or
+   -1 if this cannot be done; then nothing has been written.  */
+ssize_t
+__stdio_gather_write (FILE *fp, const char *p, size_t n)
+{
+  const size_t buffered = fp->__bufp - fp->__buffer;
+  struct iovec iov[2];
+  ssize_t count;
+  size_t done;
+  int save_errno;
+
+  /* Only a binary stream on a file descriptor, whose buffer holds
+     just what was written, is simple enough.  */
+  if (fp->__io_funcs.__write != __stdio_write
+      || fp->__room_funcs.__output != flushbuf
+      || fp->__linebuf_active || fp->__pushed_back
+      || fp->__put_limit == fp->__buffer || fp->__get_limit > fp->__bufp)
+    return -1;
+
+  if (!fp->__mode.__append)
+    {
+      seek_to_target (fp);
+      if (ferror (fp))
+	return 0;
+    }
+
+  iov[0].iov_base = fp->__buffer;
+  iov[0].iov_len = buffered;
+  iov[1].iov_base = (char *) p;
+  iov[1].iov_len = n;
+  save_errno = errno;
+  count = __stdio_writev (fp->__cookie, iov, 2);
+  if (count < 0)
+    {
+      /* The caller writes it the usual way, which sets errno itself
+	 if that fails too.  */
+      __set_errno (save_errno);
+      return -1;
+    }
+
+  /* Anything that the kernel did not take goes out the usual way.  */
+  done = count;
+  while (done < buffered + n)
+    {
+      if (done < buffered)
+	count = __stdio_write (fp->__cookie, fp->__buffer + done,
+			       buffered - done);
+      else
+	count = __stdio_write (fp->__cookie, p + (done - buffered),
+			       buffered + n - done);
+      if (count <= 0)
+	{
+	  fp->__error = 1;
+	  break;
+	}
+      done += count;
+    }
+
+  if (fp->__mode.__append)
+    /* As in flushbuf, the position is found out later if needed.  */
+    fp->__offset = fp->__target = -1;
+  else if (fp->__offset != -1)
+    {
+      fp->__offset += done;
+      fp->__target = fp->__offset;
+    }
+
+  /* The buffer is empty even after an error: what the kernel took must
+     not be written again after clearerr.  */
+  fp->__bufp = fp->__buffer;
+  fp->__get_limit = fp->__buffer;
+
+  return done > buffered ? done - buffered : 0;
+}
+
+
 /* Fill the buffer for FP and return the first character read.
    This is the function used by getc.  */
 int
@@ -688,12 +770,15 @@ __fillbf (FILE *fp)
 void
 __invalidate (FILE *stream)
 {
-  /* Save its link.  */
+  /* Save its link and its lock.  */
   register FILE *next = stream->__next;
+  struct __stdio_lock *lock = stream->__lock;
 
   /* Pulverize the deceased.  */
   memset((void *) stream, 0, sizeof(FILE));
 
-  /* Restore the deceased's link.  */
+  /* Restore the deceased's link and lock.  A thread may still hold
+     the lock, fclose unlocks the stream after nuking it.  */
   stream->__next = next;
+  stream->__lock = lock;
 }
@@ -23,3 +23,15 @@ const char _itoa_lower_digits[]
 const char _itoa_upper_digits[]
 	= "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
+/* Pairs of decimal digits, "00" to "99".  */
+const char _itoa_two_digits[]
+	= "00010203040506070809"
+	  "10111213141516171819"
+	  "20212223242526272829"
+	  "30313233343536373839"
+	  "40414243444546474849"
+	  "50515253545556575859"
+	  "60616263646566676869"
+	  "70717273747576777879"
+	  "80818283848586878889"
+	  "90919293949596979899";
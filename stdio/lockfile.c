@@ -19,15 +19,76 @@
 /* Modified for MiNTLib by Guido Flohr <guido@freemint.de>.  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <mint/mintbind.h>
+#include "lib.h"
+#include "atomicity.h"
+
+/* Threads started with tfork() share the streams.  Once there are any,
+   the streams are locked.  The lock of a stream knows the thread holding
+   it and how often that thread took it, so that it can take it again.  The
+   thread is known by its stack, see __libc_thread_id, and a free lock
+   is taken with a single compare and swap; a thread that finds
+   it held by another one yields until it is free.  Without threads
+   nothing is locked at all, so a stream locked before the first thread
+   was started is not locked.  Streams that sprintf and friends make on
+   the stack have no lock, no other thread can see them.  */
 
 __typeof__(flockfile) __internal_flockfile;
 __typeof__(funlockfile) __internal_funlockfile;
 __typeof__(ftrylockfile) __internal_ftrylockfile;
 
+#if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__)
+
+# define lock_cas(p, oldval, newval) \
+  compare_and_swap ((long *) (p), (long) (oldval), (long) (newval))
+
+#else
+
+/* No cas on the 68000 and ColdFire.  A byte set with tas makes the
+   compare and swap atomic; it is only held for that, so the streams
+   are still locked one by one.  */
+static volatile unsigned char stdio_tas;
+
+static int
+lock_cas_tas (volatile long *p, long oldval, long newval)
+{
+  int result;
+
+  while (!test_and_set (&stdio_tas))
+    (void) Syield ();
+  result = *p == oldval;
+  if (result)
+    *p = newval;
+  stdio_tas = 0;
+  return result;
+}
+
+# define lock_cas(p, oldval, newval) \
+  lock_cas_tas ((volatile long *) (p), (long) (oldval), (long) (newval))
+
+#endif
+
 void
 __internal_flockfile (FILE *stream)
 {
-  /* Do nothing.  Using this version does not do any locking.  */
+  struct __stdio_lock *lock;
+  long self;
+
+  if (!__libc_threads || !__validfp (stream)
+      || (lock = stream->__lock) == NULL)
+    return;
+
+  self = __libc_thread_id ();
+  if (lock->owner == self)
+    {
+      lock->count++;
+      return;
+    }
+  while (!lock_cas (&lock->owner, 0, self))
+    (void) Syield ();
+  lock->count = 1;
 }
 #ifdef USE_IN_LIBIO
 weak_alias (__internal_flockfile, _IO_flockfile)
@@ -37,10 +98,33 @@ weak_alias (__internal_flockfile, __flockfile)
 weak_alias (__internal_flockfile, flockfile);
 
 
+/* Release LOCK once.  fclose calls this directly, the stream it
+   unlocks is no more valid.  */
+void
+__stdio_unlock (struct __stdio_lock *lock)
+{
+  /* Only the owner unlocks, so the lock is held unless the stream was
+     locked before there were any threads.  */
+  if (lock == NULL || lock->owner == 0)
+    return;
+
+  if (--lock->count == 0)
+    lock->owner = 0;
+}
+
 void
 __internal_funlockfile (FILE *stream)
 {
-  /* Do nothing.  Using this version does not do any locking.  */
+  if (!__libc_threads || stream == NULL)
+    return;
+
+  /* No check for a valid stream here: a thread that was waiting for the
+     lock while fclose ran gets it for a stream that is closed by now.
+     The lock stays with the stream, so it must be released all the
+     same.  Only glued streams are looked up.  */
+  if (stream->__magic == _GLUEMAGIC && !__validfp (stream))
+    return;
+  __stdio_unlock (stream->__lock);
 }
 #ifdef USE_IN_LIBIO
 weak_alias (__internal_funlockfile, _IO_funlockfile)
@@ -53,8 +137,28 @@ weak_alias (__internal_funlockfile, funlockfile);
 int
 __internal_ftrylockfile (FILE *stream)
 {
-  /* Do nothing.  Using this version does not do any locking.  */
-  return 1;
+  struct __stdio_lock *lock;
+  long self;
+
+  if (!__validfp (stream))
+    {
+      __set_errno (EINVAL);
+      return -1;
+    }
+
+  if (!__libc_threads || (lock = stream->__lock) == NULL)
+    return 0;
+
+  self = __libc_thread_id ();
+  if (lock->owner == self)
+    {
+      lock->count++;
+      return 0;
+    }
+  if (!lock_cas (&lock->owner, 0, self))
+    return -1;
+  lock->count = 1;
+  return 0;
 }
 #ifdef USE_IN_LIBIO
 weak_alias (__internal_ftrylockfile, _IO_ftrylockfile)
@@ -18,6 +18,8 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "lib.h"
 
 
 /* Return a new, zeroed, stream.
@@ -35,10 +37,13 @@ __newstream (void)
     stream = stream->__next;
   if (stream == NULL)
     {
-      /* None to reuse.  */
-      stream = (FILE *) malloc (sizeof (FILE));
+      /* None to reuse.  The lock comes along with the stream and stays
+	 with it when it is reused.  */
+      stream = (FILE *) malloc (sizeof (FILE) + sizeof (struct __stdio_lock));
       if (stream == NULL)
 	return NULL;
+      stream->__lock = (struct __stdio_lock *) (stream + 1);
+      memset ((void *) stream->__lock, 0, sizeof (struct __stdio_lock));
       stream->__next = __stdio_head;
       __stdio_head = stream;
     }
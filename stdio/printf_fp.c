@@ -48,6 +48,7 @@
 # include <wchar.h>
 #endif
 #include "lib.h"
+#include "_itoa.h"
 
 #ifdef __MINT__
 # define __long_double_t long double
@@ -70,7 +71,10 @@
 #  define size_t     _IO_size_t
 #  define FILE	     _IO_FILE
 #else	/* ! USE_IN_LIBIO */
-#  define PUT(f, s, n) fwrite (s, 1, n, f)
+/* vfprintf has locked the stream.  */
+#  define PUT(f, s, n) fwrite_unlocked (s, 1, n, f)
+#  undef putc
+#  define putc(c, f) __putc (c, f)
 #  define PAD(f, c, n) __printf_pad (f, c, n)
 ssize_t __printf_pad __P ((FILE *, char pad, size_t n)); /* In vfprintf.c.  */
 #endif	/* USE_IN_LIBIO */
@@ -147,6 +151,10 @@ struct hack_digit_args {
 	MPN_VAR(scale);
 	/* Temporary bignum value.  */
 	MPN_VAR(tmp);
+	/* The digits found by fast_digits, followed by zeros; NULL if
+	   the MPN variables are used instead.  */
+	const char *digits;
+	const char *digits_end;
 };
 
 static char hack_digit (struct hack_digit_args *args)
@@ -156,6 +164,8 @@ static char hack_digit (struct hack_digit_args *args)
 
       if (args->expsign != 0 && args->type == 'f' && args->exponent-- > 0)
 	hi = 0;
+      else if (args->digits != NULL)
+	return args->digits < args->digits_end ? *args->digits++ : '0';
       else if (args->scalesize == 0)
 	{
 	  hi = args->frac[args->fracsize - 1];
@@ -191,6 +201,229 @@ static char hack_digit (struct hack_digit_args *args)
       return '0' + hi;
     }
 
+/* Nonzero if digits other than zero are still to come.  */
+static int
+rest_nonzero (const struct hack_digit_args *args)
+{
+  const char *p;
+
+  if (args->digits == NULL)
+    return args->fracsize > 1 || args->frac[0] != 0;
+  for (p = args->digits; p < args->digits_end; p++)
+    if (*p != '0')
+      return 1;
+  return 0;
+}
+
+/* Most doubles are printed without any MPN arithmetic.  Integers below
+   2^64 (and zero) are converted exactly by _itoa.  Otherwise the value
+   is multiplied by a cached power of ten held to 64 bits, and the
+   digits are taken from the product as in Loitsch's Grisu in counted
+   mode.  The product is off by less than one unit in its last place,
+   so the digits are only used when the rounding of the requested
+   number of digits is sure despite that error; ties, carries into a
+   new leading digit and products closer than that to a power of ten
+   are left to the MPN code.  The digits are passed on already rounded,
+   so the rounding in __printf_fp never changes them and the output is
+   the same as with the exact method.  */
+
+/* The binary exponent of the product is kept in ALPHA..GAMMA, so that
+   its integer part fits into 32 bits.  */
+#define FAST_ALPHA	-60
+#define FAST_GAMMA	-32
+/* Not more digits than the 64 bits of the product can give.  */
+#define FAST_MAX_DIGITS	17
+
+static const unsigned long small_pow10[] =
+{
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+  1000000000
+};
+
+/* Round the N digits in BUF, which are REST units short of the scaled
+   value, to the nearest of BUF and BUF + 1 in the last digit; TEN_KAPPA
+   is the value of a last digit, UNIT the possible error of REST.
+   Return 0 if the error leaves it open or the digits would carry into a
+   new leading digit.  */
+static int
+round_counted (char *buf, int n, unsigned long long rest,
+	       unsigned long long ten_kappa, unsigned long long unit)
+{
+  int i;
+
+  if (unit >= ten_kappa || ten_kappa - unit <= unit)
+    return 0;
+  /* sure to round down */
+  if (ten_kappa - rest > rest && ten_kappa - 2 * rest >= 2 * unit)
+    return 1;
+  /* sure to round up */
+  if (rest > unit && ten_kappa - (rest - unit) <= rest - unit)
+    {
+      for (i = n - 1; i >= 0 && buf[i] == '9'; i--)
+	buf[i] = '0';
+      if (i < 0)
+	return 0;
+      buf[i]++;
+      return 1;
+    }
+  return 0;
+}
+
+/* Write the first digits of VALUE, which is positive, finite and not
+   zero, rounded to NDIGITS significant digits, or with FIXED nonzero
+   to NDIGITS digits after the decimal point, to BUF.  *DECPT is set to
+   the position of the decimal point relative to the first digit.
+   Return the number of digits, or -1 if the MPN code has to do it.  */
+static int
+counted_digits (unsigned long long f, int e, int ndigits, int fixed,
+		char *buf, int *decpt)
+{
+  const struct fpio_cached_power *c;
+  unsigned long long w, one, frac, unit;
+  unsigned long integ, rest_int, divisor;
+  char tmp[10], *p, *end = tmp + sizeof tmp;
+  long k;
+  int shift, kappa, n, i;
+
+  /* normalize to 64 bits */
+  if (f & (1ULL << 52))
+    {
+      f <<= 11;
+      e -= 11;
+    }
+  else
+    while ((f & (1ULL << 63)) == 0)
+      {
+	f <<= 1;
+	e--;
+      }
+
+  /* the smallest power of ten that brings the exponent into range;
+     78913 / 2^18 is log10(2) */
+  k = ((long) (FAST_ALPHA - (e + 64) + 63) * 78913 + (1L << 18) - 1) >> 18;
+  c = &_fpioconst_cached_pow10[(k - _FPIO_CACHED_FIRST_K
+				 + _FPIO_CACHED_STEP - 1) / _FPIO_CACHED_STEP];
+
+  w = __fpio_mul_hi64 (f, c->f);
+  shift = -(e + c->e + 64);
+  one = 1ULL << shift;
+  integ = w >> shift;
+  frac = w & (one - 1);
+  unit = 1;
+
+  p = _itoa_word (integ, end, 10, 0);
+  kappa = end - p;
+
+  /* Too close to a power of ten to tell which side the value is on.  */
+  if (integ == small_pow10[kappa - 1] && frac <= unit)
+    return -1;
+  if (kappa < 10 && integ == small_pow10[kappa] - 1 && one - frac <= unit)
+    return -1;
+
+  *decpt = kappa - c->k;
+  n = fixed ? ndigits + *decpt : ndigits;
+  if (n <= 0 || n > FAST_MAX_DIGITS)
+    return -1;
+
+  if (n <= kappa)
+    {
+      memcpy (buf, p, n);
+      rest_int = 0;
+      for (i = n; i < kappa; i++)
+	rest_int = rest_int * 10 + (p[i] - '0');
+      divisor = small_pow10[kappa - n];
+      return round_counted (buf, n, ((unsigned long long) rest_int << shift)
+			    + frac, (unsigned long long) divisor << shift,
+			    unit) ? n : -1;
+    }
+
+  memcpy (buf, p, kappa);
+  for (i = kappa; i < n && frac > unit; i++)
+    {
+      frac = (frac << 3) + (frac << 1);
+      unit = (unit << 3) + (unit << 1);
+      buf[i] = '0' + (int) (frac >> shift);
+      frac &= one - 1;
+    }
+  if (i < n)
+    return -1;
+  return round_counted (buf, n, frac, one, unit) ? n : -1;
+}
+
+/* Set up ARGS to take the digits of the double VALUE from BUF, which
+   must have room for 20 digits.  Return zero if the MPN variables have
+   to be used.  */
+static int
+fast_digits (double value, const struct printf_info *info,
+	     struct hack_digit_args *args, char *buf, int *is_neg)
+{
+  union
+    {
+      double d;
+      unsigned long long u;
+    }
+  x;
+  unsigned long long f;
+  int bexp, e, exp10, n, ndigits, fixed;
+  char *end = buf + 20;
+
+  x.d = value;
+  *is_neg = (int) (x.u >> 63);
+  bexp = (int) (x.u >> 52) & 0x7ff;
+  f = x.u & ((1ULL << 52) - 1);
+  if (bexp == 0)
+    e = -1074;
+  else
+    {
+      f |= 1ULL << 52;
+      e = bexp - 1075;
+    }
+
+  if (f == 0)
+    {
+      args->digits = args->digits_end = end;
+      exp10 = 0;
+    }
+  else if ((e >= 0 && e <= 11)
+	   || (e < 0 && e > -53 && (f & ((1ULL << -e) - 1)) == 0))
+    {
+      /* an integer below 2^64 */
+      f = e >= 0 ? f << e : f >> -e;
+      if ((f >> 32) == 0)
+	args->digits = _itoa_word ((unsigned long) f, end, 10, 0);
+      else
+	args->digits = _itoa (f, end, 10, 0);
+      args->digits_end = end;
+      exp10 = end - args->digits - 1;
+    }
+  else
+    {
+      /* the same number of digits as asked for below */
+      fixed = 0;
+      if (_tolower (info->spec) == 'e')
+	ndigits = (info->prec < 0 ? 6 : info->prec) + 1;
+      else if (info->spec == 'f')
+	{
+	  ndigits = info->prec < 0 ? 6 : info->prec;
+	  fixed = 1;
+	}
+      else
+	ndigits = info->prec < 0 ? 6 : (info->prec == 0 ? 1 : info->prec);
+
+      n = counted_digits (f, e, ndigits, fixed, buf, &exp10);
+      if (n < 0)
+	return 0;
+      args->digits = buf;
+      args->digits_end = buf + n;
+      exp10--;
+    }
+
+  args->expsign = exp10 < 0;
+  args->exponent = exp10 < 0 ? -exp10 : exp10;
+  args->scalesize = 0;
+  return 1;
+}
+
 int
 __printf_fp (FILE *fp,
 	     const struct printf_info *info,
@@ -241,8 +474,12 @@ __printf_fp (FILE *fp,
 
   struct hack_digit_args hack_info;
 
+  /* The digits of the fast path.  */
+  char fast_buf[20];
+
   hack_info.expsign = 0;
   hack_info.exponent = 0;
+  hack_info.digits = NULL;
 
 #ifndef __MINT__
   /* Figure out the decimal point character.  */
@@ -361,7 +598,7 @@ __printf_fp (FILE *fp,
 	  special = isupper (info->spec) ? "INF" : "inf";
 	  is_neg = fpnum.dbl < 0;
 	}
-      else
+      else if (!fast_digits (fpnum.dbl, info, &hack_info, fast_buf, &is_neg))
 	{
 	  hack_info.fracsize = __mpn_extract_double (fp_input,
 					   (sizeof (fp_input)
@@ -397,6 +634,8 @@ __printf_fp (FILE *fp,
       return done;
     }
 
+  if (hack_info.digits != NULL)
+    goto have_digits;
 
   /* We need three multiprecision variables.  Now that we have the exponent
      of the number we can allocate the needed memory.  It would be more
@@ -738,6 +977,7 @@ __printf_fp (FILE *fp,
       hack_info.exponent = 0;
     }
 
+ have_digits:
   {
     int width = info->width;
     char *buffer, *startp, *cp;
@@ -834,7 +1074,7 @@ __printf_fp (FILE *fp,
 	significant = 1;
 	if (info->alt
 	    || fracdig_min > 0
-	    || (fracdig_max > 0 && (hack_info.fracsize > 1 || hack_info.frac[0] != 0)))
+	    || (fracdig_max > 0 && rest_nonzero (&hack_info)))
 	  *cp++ = decimal;
       }
     else
@@ -848,7 +1088,7 @@ __printf_fp (FILE *fp,
 
     /* Generate the needed number of fractional digits.	 */
     while (fracdig_no < fracdig_min
-	   || (fracdig_no < fracdig_max && (hack_info.fracsize > 1 || hack_info.frac[0] != 0)))
+	   || (fracdig_no < fracdig_max && rest_nonzero (&hack_info)))
       {
 	++fracdig_no;
 	*cp = hack_digit (&hack_info);
@@ -872,11 +1112,11 @@ __printf_fp (FILE *fp,
 	if (digit == '5' && (*(cp - 1) & 1) == 0)
 	  {
 	    /* This is the critical case.	 */
-	    if (hack_info.fracsize == 1 && hack_info.frac[0] == 0)
+	    if (!rest_nonzero (&hack_info))
 	      /* Rest of the number is zero -> round to even.
 		 (IEEE 754-1985 4.1 says this is the default rounding.)  */
 	      goto do_expo;
-	    else if (hack_info.scalesize == 0)
+	    else if (hack_info.digits == NULL && hack_info.scalesize == 0)
 	      {
 		/* Here we have to see whether all limbs are zero since no
 		   normalization happened.  */
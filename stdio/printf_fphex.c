@@ -59,7 +59,10 @@
 # define size_t     _IO_size_t
 # define FILE	     _IO_FILE
 #else	/* ! USE_IN_LIBIO */
-# define PUT(f, s, n) fwrite (s, 1, n, f)
+/* vfprintf has locked the stream.  */
+# define PUT(f, s, n) fwrite_unlocked (s, 1, n, f)
+# undef putc
+# define putc(c, f) __putc (c, f)
 # define PAD(f, c, n) __printf_pad (f, c, n)
 ssize_t __printf_pad __P ((FILE *, char pad, size_t n)); /* In vfprintf.c.  */
 #endif	/* USE_IN_LIBIO */
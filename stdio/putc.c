@@ -3,5 +3,3 @@
 #define	fputc	putc
 #define fputc_unlocked	putc_unlocked
 #include "fputc.c"
-
-weak_alias (putc, putc_unlocked)
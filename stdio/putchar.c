@@ -16,6 +16,7 @@
    <https://www.gnu.org/licenses/>.  */
 
 #include <stdio.h>
+#include "lib.h"
 
 #undef	putchar
 
@@ -24,7 +25,17 @@
 int
 putchar (int c)
 {
-  return __putc (c, stdout);
+  int result;
+
+  __STDIO_LOCK (stdout);
+  result = __putc (c, stdout);
+  __STDIO_UNLOCK (stdout);
+  return result;
 }
 
-weak_alias (putchar, putchar_unlocked)
+/* Write the character C on stdout without locking it.  */
+int
+putchar_unlocked (int c)
+{
+  return __putc (c, stdout);
+}
@@ -18,6 +18,7 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include "lib.h"
 
 #undef	puts
 
@@ -26,5 +27,10 @@
 int
 puts (const char *s)
 {
-  return fputs (s, stdout) || putchar ('\n') == EOF ? EOF : 0;
+  int result;
+
+  __STDIO_LOCK (stdout);
+  result = fputs_unlocked (s, stdout) || __putc ('\n', stdout) == EOF ? EOF : 0;
+  __STDIO_UNLOCK (stdout);
+  return result;
 }
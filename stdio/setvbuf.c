@@ -19,11 +19,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include "lib.h"
 
 
 /* Make STREAM use the buffering method given in MODE.
    If MODE indicates full or line buffering, use BUF,
-   a buffer of SIZE bytes; if BUF is NULL, malloc a buffer.  */
+   a buffer of SIZE bytes; if BUF is NULL, malloc a buffer.
+   If both BUF and SIZE are zero, the buffer gets the size that
+   stdio would choose for the file (see __stdio_bufsize).  */
 int
 setvbuf (FILE *stream, char *buf, int mode, size_t size)
 {
@@ -33,6 +36,12 @@ setvbuf (FILE *stream, char *buf, int mode, size_t size)
       return EOF;
     }
 
+  if (buf == NULL && size == 0 && (mode == _IOFBF || mode == _IOLBF))
+    {
+      __stdio_check_funcs (stream);
+      size = __stdio_bufsize (stream);
+    }
+
   /* The ANSI standard says setvbuf can only be called before any I/O is done,
      but we allow it to replace an old buffer, flushing it first.  */
   if (stream->__buffer != NULL)
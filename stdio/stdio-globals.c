@@ -48,6 +48,7 @@ typedef struct
 #endif
 
 #define STD_STREAM(NAME, FD, STREAM_MODE, CHAIN) \
+	static struct __stdio_lock __##NAME##_lock; \
 	static FILE __##NAME = { \
 		_IOMAGIC, \
 		NULL, \
@@ -62,7 +63,7 @@ typedef struct
 		(fpos_t) -1, \
 		(fpos_t) -1, \
 		CHAIN, \
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, NULL }; \
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, &__##NAME##_lock }; \
 	FILE* NAME = &__##NAME;
 
 STD_STREAM(stdin, 0, STDIN_MODE, NULL);
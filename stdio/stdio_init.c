@@ -17,7 +17,9 @@
 
 /* Modified for MiNTLib by Guido Flohr <guido@freemint.de>.  */
 
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -27,6 +29,100 @@
 # define __fstat(fd, sb) __do_fstat (fd, sb, 0)
 #endif
 
+/* A regular file gets a buffer of at least this size, rounded up to a
+   multiple of its block size, so that sequential reads and writes
+   need few system calls.  */
+#define FILE_BUFSIZE	8192
+
+/* Block sizes and sizes from the environment beyond these are not
+   believed.  */
+#define MIN_BUFSIZE	128
+#define MAX_BUFSIZE	(1024L * 1024L)
+
+/* The buffer size from the environment variable STDIO_BUFSIZE, or 0
+   if it is not set.  It is used for every stream that does not get a
+   buffer from setvbuf.  */
+static size_t
+env_bufsize (void)
+{
+  static int checked;
+  static size_t size;
+
+  if (!checked)
+    {
+      const char *s = getenv ("STDIO_BUFSIZE");
+
+      checked = 1;
+      if (s != NULL)
+	{
+	  unsigned long int n = strtoul (s, NULL, 0);
+
+	  if (n >= MIN_BUFSIZE && n <= MAX_BUFSIZE)
+	    size = n;
+	}
+    }
+  return size;
+}
+
+/* The buffer size for a file with the status in ST.  Pipes and sockets
+   get PIPE_BUF bytes, which is as much as they pass in one go;
+   terminals and other devices BUFSIZ.  A size from the environment,
+   or else one that the program stored in __DEFAULT_BUFSIZ__, is used
+   for all of them.  */
+static size_t
+pick_bufsize (const struct stat *st)
+{
+  size_t size = env_bufsize ();
+  size_t blksize = 0;
+
+  if (size != 0)
+    return size;
+  if (__DEFAULT_BUFSIZ__ != 0)
+    return __DEFAULT_BUFSIZ__;
+
+#ifdef	_STATBUF_ST_BLKSIZE
+  if (st->st_blksize >= MIN_BUFSIZE && st->st_blksize <= MAX_BUFSIZE)
+    blksize = st->st_blksize;
+#endif
+
+  if (S_ISREG (st->st_mode))
+    {
+      size = FILE_BUFSIZE;
+      if (blksize != 0)
+	size = (size + blksize - 1) / blksize * blksize;
+    }
+  else if (S_ISFIFO (st->st_mode)
+#ifdef S_ISSOCK
+	   || S_ISSOCK (st->st_mode)
+#endif
+	   )
+    size = PIPE_BUF;
+  else
+    size = BUFSIZ;
+  return size;
+}
+
+/* Return the size of the buffer that STREAM gets when it is buffered
+   and setvbuf did not say how big the buffer is.  */
+size_t
+__stdio_bufsize (FILE *stream)
+{
+  struct stat statb;
+  int fd = -1;
+
+  if (stream->__io_funcs.__fileno != NULL)
+    fd = (*stream->__io_funcs.__fileno) (stream->__cookie);
+  if (fd < 0 || __fstat (fd, &statb) < 0)
+    {
+      /* nothing known about the file, so it is a device */
+      statb.st_mode = __S_IFCHR;
+#ifdef	_STATBUF_ST_BLKSIZE
+      statb.st_blksize = 0;
+#endif
+    }
+  return pick_bufsize (&statb);
+}
+
 /* Initialize STREAM as necessary.
    This may change I/O functions, give a buffer, etc.
    If no buffer is allocated, but the bufsize is set,
@@ -71,12 +167,5 @@ __stdio_init_stream (FILE *stream)
 	}
     }
 
-#ifdef	_STATBUF_ST_BLKSIZE
-  /* Use the block-size field to determine
-     the system's optimal buffering size.  */
-  stream->__bufsize = statb.st_blksize;
-#else
-  /* Fstat is to unreliable at the moment.  */
-  stream->__bufsize = BUFSIZ;
-#endif
+  stream->__bufsize = pick_bufsize (&statb);
 }
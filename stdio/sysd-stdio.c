@@ -27,6 +27,8 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#include <mint/mintbind.h>
 #include "lib.h"
 
 extern __io_read_fn __stdio_read;
@@ -36,6 +38,8 @@ extern __io_write_fn __stdio_text_write;
 extern __io_seek_fn __stdio_seek;
 extern __io_close_fn __stdio_close;
 extern __io_fileno_fn __stdio_fileno;
+extern ssize_t __stdio_writev (void *cookie, const struct iovec *iov,
+			       int niov);
 
 /* Read N bytes into BUF from COOKIE.  */
 ssize_t
@@ -78,11 +82,9 @@ __stdio_text_read (void* cookie, char* buf, size_t n)
 #endif
 
   int save = errno;
-  ssize_t nread = 0;
-  char* bufptr = buf;
   ssize_t read_bytes;
-  ssize_t i;
-  ssize_t skipped = 0;
+  char *src, *dst, *end, *run;
+  int peeked = 0;
 
   if (n == 0)
     {
@@ -99,65 +101,48 @@ __stdio_text_read (void* cookie, char* buf, size_t n)
   /* The last read character may be \r.  */
   /* In that case, we will need to read an additional character.  */
   /* So read n-1 characters in order to keep room for that special case.  */
-  read_bytes = __read (fd, bufptr, n-1);
-  if (read_bytes < 0) 
+  read_bytes = __read (fd, buf, n-1);
+  if (read_bytes <= 0)
     {
-      return -1;
+      return read_bytes;
     }
-  
-  if (read_bytes == 0)
-    {
-      __set_errno (save);
-      return 0;
-    }
-  
-  /* Now squeeze \r\n characters into \n.  */
-  read_bytes--;
-  for (i = 0; i < read_bytes; i++)
+
+  /* Now squeeze \r\n characters into \n.  The text between two CRs
+     is moved down as a whole.  */
+  end = buf + read_bytes;
+  src = memchr (buf, '\r', read_bytes);
+  if (src == NULL)
     {
-      if (bufptr[i] == '\r')
-        {
-          if (bufptr[i+1] == '\n')
-            {
-              skipped++;
-              continue;
-            }
-        }
-      bufptr[i - skipped] = bufptr[i];
+      return read_bytes;
     }
-  read_bytes -= skipped;
-  bufptr += read_bytes;
-  nread += read_bytes;
-  
-  /* handle last character */
-  if (bufptr[skipped] == '\r')
+  dst = src;
+  while (src < end)
     {
-      /* last character is a CR */
-      i = __read (fd, bufptr+skipped+1, 1);
-      if (i == 1)
+      /* SRC is at a CR.  */
+      if (src + 1 == end && !peeked)
         {
-          if (bufptr[skipped+1] != '\n')
+          /* last character is a CR */
+          peeked = 1;
+          if (__read (fd, end, 1) == 1)
             {
-              bufptr[0] = bufptr[skipped];
-              bufptr[1] = bufptr[skipped+1];
-              
-              bufptr += 1;
-              nread += 1;
+              if (*end == '\n')
+                src++;
+              end++;
             }
-          else
-              bufptr[0] = '\n';
         }
-      else
-        bufptr[0] = bufptr[skipped];
+      else if (src + 1 < end && src[1] == '\n')
+        src++;
+
+      run = memchr (src + 1, '\r', end - (src + 1));
+      if (run == NULL)
+        run = end;
+      memmove (dst, src, run - src);
+      dst += run - src;
+      src = run;
     }
-  else
-    bufptr[0] = bufptr[skipped];
-  
-  bufptr++;
-  nread++;
-    
+
   __set_errno (save);
-  return nread;
+  return dst - buf;
 }
 
 /* Write N bytes from BUF to COOKIE.  */
@@ -192,74 +177,119 @@ __stdio_write (void *cookie, const char *buf, size_t n)
   return (ssize_t) written;
 }
 
-/* Write N bytes from BUF to COOKIE in so-called text mode.  */
+/* Set when the kernel turned out to have no Fwritev.  */
+static int no_writev;
+
+/* Write the NIOV buffers in IOV to COOKIE with one Fwritev.  Return
+   the number of bytes written, or -1 if nothing was written.  Unlike
+   writev this never falls back to sendmsg or to a copy of the data;
+   the caller is expected to write the buffers itself then.  */
 ssize_t
-__stdio_text_write (void *cookie, const char *buf, size_t n)
+__stdio_writev (void *cookie, const struct iovec *iov, int niov)
 {
-#ifndef __MSHORT__
-  const int fd = (int) cookie;
-#else
-  const long int fd = (long int) cookie;
-#endif
-  register size_t written = 0;
-  size_t blocksize = 8192;
-  struct stat statbuf;
-  int save = errno;
-  char* chunk;
+  long r;
 
-  if (fstat (fd, &statbuf) == 0) 
+  if (no_writev)
     {
-      blocksize = (ssize_t) statbuf.st_blksize;
-      if (blocksize > 8192 || blocksize <= 0)
-        blocksize = 8192;
+      __set_errno (ENOSYS);
+      return -1;
     }
-  
-  __set_errno (save);
 
-  /* The buffer is one byte bigger than actually needed for the case of
-     a linefeed as the last char in the current chunk.  */  
-  chunk = alloca (blocksize + 1);
-  
-  while (n > 0)
+  r = Fwritev ((int) ((long) cookie), iov, niov);
+  if (r < 0)
     {
-      ssize_t count;
-      register size_t put;
-      register size_t got;
-      char* writeptr = chunk;
-      size_t n1;
-      size_t limit = blocksize > n ? n : blocksize;
-      
-      for (put = 0, got = 0; put < limit && got < n; put++, got++)
+      if (r == -ENOSYS)
+	no_writev = 1;
+      __set_errno (-r);
+      return -1;
+    }
+  return r;
+}
+
+/* Text written in text mode gets a CR in front of every LF.  Small
+   writes are translated in a chunk of at most this many bytes on the
+   stack, which must stay small: threads from tfork have 4 KB of stack,
+   and _stksize may be small as well.  Anything bigger, such as a whole
+   buffer that is flushed, is translated in a buffer from the heap so
+   that it goes out with one write; only if there is no memory for
+   that it is written a chunk at a time.  */
+#define TEXT_CHUNK 1024
+
+/* Copy N bytes from BUF to COOKIE in pieces of SIZE bytes at CHUNK,
+   with a CR added in front of every LF.  */
+static int
+text_write_chunks (void *cookie, const char *buf, size_t n,
+		   char *chunk, size_t size)
+{
+  const char *end = buf + n;
+  const char *p, *nl;
+  char *q, *chunk_end;
+  size_t len;
+
+  chunk_end = chunk + size;
+  q = chunk;
+  p = buf;
+  while (p < end)
+    {
+      /* copy the line up to the LF, or as much as fits */
+      nl = memchr (p, '\n', end - p);
+      len = (nl != NULL ? nl : end) - p;
+      if (len > (size_t) (chunk_end - q))
+        len = chunk_end - q;
+      memcpy (q, p, len);
+      q += len;
+      p += len;
+
+      if (p == nl && chunk_end - q >= 2)
         {
-          if (buf[got] == '\n')
-            chunk[put++] = '\r';
-          chunk[put] = buf[got];
+          *q++ = '\r';
+          *q++ = '\n';
+          p++;
         }
-
-      n1 = put;
-      while (n1 > 0)
+      else if (p < end)
         {
-          count = __write (fd, writeptr, n1);
-          if (count > 0)
-            {
-              writeptr += count;
-              n1 -= count;
-            }
-          else if (count < 0
-#if defined EINTR && defined EINTR_REPEAT
-                   && errno != EINTR
-#endif
-                   )
-            /* Write error.  */
+          /* The chunk is full.  */
+          if (__stdio_write (cookie, chunk, q - chunk) < 0)
             return -1;
+          q = chunk;
         }
-      
-      buf += got;
-      written += got;
-      n -= got;      
     }
 
-  return (ssize_t) written;
+  if (q > chunk && __stdio_write (cookie, chunk, q - chunk) < 0)
+    return -1;
+  return 0;
+}
+
+/* Write N bytes from BUF to COOKIE in so-called text mode.  */
+ssize_t
+__stdio_text_write (void *cookie, const char *buf, size_t n)
+{
+  const char *end = buf + n;
+  const char *p;
+  size_t size = n;
+  char *chunk, *heap = NULL;
+  int save, result;
+
+  if (n == 0)
+    return 0;
+
+  /* Room for a CR in front of every LF.  */
+  for (p = buf; (p = memchr (p, '\n', end - p)) != NULL; p++)
+    size++;
+
+  if (size > TEXT_CHUNK)
+    {
+      save = errno;
+      heap = malloc (size);
+      __set_errno (save);
+      if (heap == NULL)
+	size = TEXT_CHUNK;
+    }
+  chunk = heap != NULL ? heap : alloca (size);
+
+  result = text_write_chunks (cookie, buf, n, chunk, size);
+  free (heap);
+  return result < 0 ? -1 : (ssize_t) n;
 }
 
 /* Move COOKIE's file position *POS bytes, according to WHENCE.
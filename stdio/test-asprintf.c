@@ -0,0 +1,75 @@
+/* asprintf and snprintf write the output straight into their buffer;
+   check them around the sizes where asprintf moves from the buffer on
+   its stack to one from malloc and where it grows that.  */
+
+#define _GNU_SOURCE 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int result;
+
+static void
+check_length (size_t len)
+{
+  char *fill = malloc (len + 1), *s = NULL, buf[16];
+  int r;
+
+  if (fill == NULL)
+    {
+      puts ("out of memory");
+      result = 1;
+      return;
+    }
+  memset (fill, 'x', len);
+  fill[len] = '\0';
+
+  /* the string first, then a few more characters through the format */
+  r = asprintf (&s, "%s%d%5s|", fill, 42, "ab");
+  if (r != (int) len + 8 || s == NULL
+      || strncmp (s, fill, len) != 0 || strcmp (s + len, "42   ab|") != 0)
+    {
+      printf ("asprintf of %lu characters failed\n", (unsigned long) len);
+      result = 1;
+    }
+  free (s);
+
+  r = snprintf (buf, sizeof buf, "%s%d", fill, 42);
+  if (r != (int) len + 2
+      || strlen (buf) != (len + 2 < sizeof buf ? len + 2 : sizeof buf - 1)
+      || strncmp (buf, fill, len < sizeof buf - 1 ? len : sizeof buf - 1))
+    {
+      printf ("snprintf of %lu characters failed\n", (unsigned long) len);
+      result = 1;
+    }
+  free (fill);
+}
+
+int
+main (void)
+{
+  static const size_t lengths[] =
+    { 0, 1, 7, 8, 14, 15, 100, 118, 119, 120, 127, 128, 255, 256, 1000,
+      10000 };
+  char buf[8];
+  size_t i;
+
+  for (i = 0; i < sizeof lengths / sizeof lengths[0]; i++)
+    check_length (lengths[i]);
+
+  if (snprintf (buf, sizeof buf, "%s-%d", "abc", 12345) != 9
+      || strcmp (buf, "abc-123") != 0)
+    {
+      puts ("snprintf does not truncate");
+      result = 1;
+    }
+  if (snprintf (NULL, 0, "%d", 1234) != 4)
+    {
+      puts ("snprintf does not count without a buffer");
+      result = 1;
+    }
+
+  if (result == 0)
+    puts ("Test succeeded.");
+  return result;
+}
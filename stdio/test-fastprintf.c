@@ -0,0 +1,180 @@
+/* Formats that printf compiles and caches: the output must be right
+   for all kinds of streams, also one that was reading, and a format
+   buffer that is written over must not see the old format.  The
+   expected output is spelled out, sprintf takes the same path.  */
+
+#include <limits.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static int result;
+
+static void
+check (const char *what, const char *got, const char *expected)
+{
+  if (strcmp (got, expected) != 0)
+    {
+      printf ("%s: got \"%s\", expected \"%s\"\n", what, got, expected);
+      result = 1;
+    }
+}
+
+/* Print with FORMAT to a stream with buffer mode MODE and buffer size
+   SIZE, and compare with EXPECTED.  */
+static void
+check_stream (int mode, size_t size, const char *expected,
+	      const char *format, ...)
+{
+  char got[4096];
+  va_list ap;
+  FILE *f = tmpfile ();
+  size_t n;
+  int r;
+
+  if (f == NULL)
+    {
+      perror ("tmpfile");
+      result = 1;
+      return;
+    }
+  setvbuf (f, NULL, mode, size);
+
+  va_start (ap, format);
+  r = vfprintf (f, format, ap);
+  va_end (ap);
+
+  rewind (f);
+  n = fread (got, 1, sizeof got - 1, f);
+  got[n] = '\0';
+  fclose (f);
+
+  check (format, got, expected);
+  if (r != (int) strlen (expected))
+    {
+      printf ("%s: returned %d, expected %d\n", format, r,
+	      (int) strlen (expected));
+      result = 1;
+    }
+}
+
+/* Print into a read/write stream after reading from it.  */
+static void
+check_after_read (int mode, size_t size)
+{
+  char got[32];
+  FILE *f = tmpfile ();
+  size_t n;
+  int r;
+
+  if (f == NULL)
+    {
+      perror ("tmpfile");
+      result = 1;
+      return;
+    }
+  setvbuf (f, NULL, mode, size);
+  fputs ("abcdefghij", f);
+  rewind (f);
+  getc (f);
+  getc (f);
+  getc (f);
+  fseek (f, 0, SEEK_CUR);
+  r = fprintf (f, "%d%s", 12, "XY");
+  if (r != 4 || ftell (f) != 7)
+    {
+      printf ("after read: returned %d at %ld, expected 4 at 7\n",
+	      r, ftell (f));
+      result = 1;
+    }
+
+  rewind (f);
+  n = fread (got, 1, sizeof got - 1, f);
+  got[n] = '\0';
+  fclose (f);
+  check ("after read", got, "abc12XYhij");
+}
+
+/* A buffered stream with an error takes nothing more.  */
+static void
+check_error (void)
+{
+  int fd[2];
+  FILE *f;
+
+  signal (SIGPIPE, SIG_IGN);
+  if (pipe (fd) != 0 || (f = fdopen (fd[1], "w")) == NULL)
+    {
+      perror ("pipe");
+      result = 1;
+      return;
+    }
+  close (fd[0]);
+  setvbuf (f, NULL, _IOFBF, BUFSIZ);
+  fputs ("x", f);
+  fflush (f);
+  if (!ferror (f))
+    {
+      puts ("error: no error from a pipe without reader");
+      result = 1;
+    }
+  else if (fprintf (f, "%d", 1) >= 0)
+    {
+      puts ("error: fprintf succeeded on a stream with an error");
+      result = 1;
+    }
+  fclose (f);
+}
+
+int
+main (void)
+{
+  static const int modes[] = { _IONBF, _IOLBF, _IOFBF };
+  static const size_t sizes[] = { 1, 8, BUFSIZ };
+  char buf[256], fmt[32], big[2000], bigout[2100];
+  int i, j;
+
+  sprintf (buf, "%d %i %u %x %X", -1234, 0, 4000000000U, 0xcafeU, 0xcafeU);
+  check ("ints", buf, "-1234 0 4000000000 cafe CAFE");
+  sprintf (buf, "%d %ld %lx %lu", INT_MIN, -7L, 0x12345678UL, 0UL);
+  check ("limits", buf, INT_MIN == -32767 - 1
+	 ? "-32768 -7 12345678 0" : "-2147483648 -7 12345678 0");
+  sprintf (buf, "[%s] [%s] %c%%", "str", (char *) NULL, 'x');
+  check ("strings", buf, "[str] [(null)] x%");
+
+  /* the same format buffer, written over */
+  strcpy (fmt, "a%db");
+  sprintf (buf, fmt, 1);
+  check ("reused 1", buf, "a1b");
+  strcpy (fmt, "%s=%x");
+  sprintf (buf, fmt, "b", 255);
+  check ("reused 2", buf, "b=ff");
+  strcpy (fmt, "%5d");
+  sprintf (buf, fmt, 3);
+  check ("reused 3", buf, "    3");
+
+  memset (big, 'z', sizeof big - 1);
+  big[sizeof big - 1] = '\0';
+  strcpy (bigout, "<");
+  strcat (bigout, big);
+  strcat (bigout, ">!\nend");
+  for (i = 0; i < 3; i++)
+    for (j = 0; j < 3; j++)
+      {
+	check_stream (modes[i], sizes[j], "line 1\nno 2\n",
+		      "line %d\nno %u\n", 1, 2U);
+	check_stream (modes[i], sizes[j], bigout,
+		      "<%s>%c\n%s", big, '!', "end");
+	check_stream (modes[i], sizes[j], "abc%-5",
+		      "%x%%%d", 0xabcU, -5);
+	check_after_read (modes[i], sizes[j]);
+      }
+
+  check_error ();
+
+  if (result == 0)
+    puts ("Test succeeded.");
+  return result;
+}
@@ -0,0 +1,116 @@
+/* fseeko and ftello on a file that is larger than the stream buffer:
+   seeks that stay inside the data read into the buffer and seeks that
+   leave it, mixed with ungetc and with writes on an update stream.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+#define SIZE 20000
+
+static int
+byte (off_t pos)
+{
+  return (int) ((pos * 7 + pos / 256) & 0xff);
+}
+
+int
+main (void)
+{
+  FILE *fp = tmpfile ();
+  off_t pos, want;
+  unsigned long seed = 1;
+  int i, c, bufsize;
+
+  if (fp == NULL)
+    {
+      perror ("tmpfile");
+      return 1;
+    }
+  for (pos = 0; pos < SIZE; pos++)
+    putc (byte (pos), fp);
+
+  for (bufsize = 64; bufsize <= 4096; bufsize *= 8)
+    {
+      if (fseeko (fp, 0, SEEK_SET) != 0
+	  || setvbuf (fp, NULL, _IOFBF, bufsize) != 0)
+	{
+	  puts ("cannot set up the stream");
+	  return 1;
+	}
+
+      pos = 0;
+      for (i = 0; i < 5000; i++)
+	{
+	  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+	  switch ((seed >> 16) % 4)
+	    {
+	    case 0:
+	      /* nearby, mostly inside the buffer */
+	      want = pos + (long) ((seed >> 4) % 200) - 100;
+	      if (want < 0)
+		want = 0;
+	      if (fseeko (fp, want - pos, SEEK_CUR) != 0)
+		{
+		  puts ("SEEK_CUR failed");
+		  return 1;
+		}
+	      break;
+	    case 1:
+	      want = (seed >> 4) % SIZE;
+	      if (fseeko (fp, want, SEEK_SET) != 0)
+		{
+		  puts ("SEEK_SET failed");
+		  return 1;
+		}
+	      break;
+	    case 2:
+	      /* the pushed back character must be forgotten */
+	      want = pos / 2;
+	      ungetc ('x', fp);
+	      if (fseeko (fp, want, SEEK_SET) != 0)
+		{
+		  puts ("SEEK_SET after ungetc failed");
+		  return 1;
+		}
+	      break;
+	    default:
+	      want = pos;
+	      break;
+	    }
+
+	  if (ftello (fp) != want)
+	    {
+	      printf ("ftello gives %ld, expected %ld\n", (long) ftello (fp),
+		      (long) want);
+	      return 1;
+	    }
+	  if (want < SIZE)
+	    {
+	      c = getc (fp);
+	      if (c != byte (want))
+		{
+		  printf ("byte %ld is %d, expected %d\n", (long) want, c,
+			  byte (want));
+		  return 1;
+		}
+	      want++;
+	    }
+	  pos = want;
+	}
+    }
+
+  /* write at a position inside the buffer, then read it back */
+  if (fseeko (fp, 100, SEEK_SET) != 0 || getc (fp) != byte (100)
+      || fseeko (fp, 50, SEEK_SET) != 0 || putc ('A', fp) != 'A'
+      || fseeko (fp, 49, SEEK_SET) != 0 || getc (fp) != byte (49)
+      || getc (fp) != 'A' || getc (fp) != byte (51))
+    {
+      puts ("write after a seek inside the buffer failed");
+      return 1;
+    }
+
+  fclose (fp);
+  puts ("Test succeeded.");
+  return 0;
+}
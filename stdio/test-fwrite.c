@@ -1,8 +1,65 @@
+#include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 long _stksize = 256L * 1024L;
 
+/* Data bigger than the buffer after some that is buffered goes out
+   with the buffer in one write; check what arrives at the other end
+   of a pipe, and that errno is left alone if Fwritev is missing.  */
+static int
+test_pipe (void)
+{
+  char obuf[200], ibuf[sizeof obuf + 8];
+  int fd[2];
+  FILE *f;
+  ssize_t n, got;
+
+  if (pipe (fd) != 0)
+    {
+      perror ("pipe");
+      return 1;
+    }
+  f = fdopen (fd[1], "w");
+  if (f == NULL)
+    {
+      perror ("fdopen");
+      return 1;
+    }
+  setvbuf (f, NULL, _IOFBF, 64);
+
+  memset (obuf, 'p', sizeof obuf);
+  fputs ("head", f);
+  errno = 0;
+  if (fwrite (obuf, sizeof obuf, 1, f) != 1)
+    {
+      perror ("fwrite to pipe");
+      return 1;
+    }
+  if (errno != 0)
+    {
+      printf ("fwrite to pipe succeeded with errno %d\n", errno);
+      return 1;
+    }
+  fclose (f);
+
+  for (got = 0; got < (ssize_t) sizeof ibuf; got += n)
+    {
+      n = read (fd[0], ibuf + got, sizeof ibuf - got);
+      if (n <= 0)
+	break;
+    }
+  close (fd[0]);
+  if (got != 4 + (ssize_t) sizeof obuf || memcmp (ibuf, "head", 4) != 0
+      || memcmp (ibuf + 4, obuf, sizeof obuf) != 0)
+    {
+      puts ("Pipe data differ.  Test FAILED!");
+      return 1;
+    }
+  return 0;
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -31,6 +88,12 @@ main (int argc, char *argv[])
       perror ("fwrite");
       return 1;
     }
+  if (ftell (f) != 5 + (long) sizeof obuf)
+    {
+      printf ("ftell after fwrite: %ld, expected %ld\n",
+	      ftell (f), 5 + (long) sizeof obuf);
+      return 1;
+    }
 
   rewind (f);
 
@@ -65,6 +128,9 @@ GDB is free software and you are welcome to distribute copies of it\n\
 There is absolutely no warranty for GDB; type \"show warranty\" for details.\n\
 ");
 
+  if (test_pipe () != 0)
+    return 1;
+
   puts ("Test succeeded.");
   return 0;
 }
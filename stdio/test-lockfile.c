@@ -0,0 +1,175 @@
+/* flockfile, ftrylockfile and funlockfile, and a stream that is written
+   by threads from tfork at the same time: one with fputs, one with
+   putc_unlocked between flockfile and funlockfile, and the main program
+   with fwrite.  Every line must come out whole and in order.  Then a
+   stream is closed while a thread waits for its lock; the lock must be
+   free afterwards for the stream that reuses it.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <support.h>
+#include <sys/wait.h>
+
+#define LINES 500
+
+static FILE *fp, *gp;
+static volatile int waiting;
+
+/* "X nnnn\n" for the line I of writer X */
+static void
+make_line (char *line, int who, int i)
+{
+  line[0] = who;
+  line[1] = ' ';
+  line[2] = '0' + i / 1000 % 10;
+  line[3] = '0' + i / 100 % 10;
+  line[4] = '0' + i / 10 % 10;
+  line[5] = '0' + i % 10;
+  line[6] = '\n';
+  line[7] = '\0';
+}
+
+static int
+puts_writer (long who)
+{
+  char line[8];
+  int i;
+
+  for (i = 0; i < LINES; i++)
+    {
+      make_line (line, (int) who, i);
+      fputs (line, fp);
+    }
+  return 0;
+}
+
+static int
+putc_writer (long who)
+{
+  char line[8];
+  const char *p;
+  int i;
+
+  for (i = 0; i < LINES; i++)
+    {
+      make_line (line, (int) who, i);
+      flockfile (fp);
+      for (p = line; *p != '\0'; p++)
+	putc_unlocked (*p, fp);
+      funlockfile (fp);
+    }
+  return 0;
+}
+
+/* GP is locked by the main program.  */
+static int
+closed_waiter (long arg)
+{
+  if (__libc_threads && ftrylockfile (gp) == 0)
+    return 1;
+  waiting = 1;
+  /* This waits until the main program unlocks or closes GP.  */
+  fputc ('y', gp);
+  return 0;
+}
+
+int
+main (void)
+{
+  char line[32], want[8];
+  int next[3] = { 0, 0, 0 };
+  int i, who, status;
+
+  fp = tmpfile ();
+  gp = tmpfile ();
+  if (fp == NULL || gp == NULL)
+    {
+      perror ("tmpfile");
+      return 1;
+    }
+
+  /* A small buffer, so that it is flushed often.  */
+  setvbuf (fp, NULL, _IOFBF, 64);
+
+  if (tfork (puts_writer, 'A') < 0 || tfork (putc_writer, 'B') < 0)
+    {
+      perror ("tfork");
+      return 1;
+    }
+
+  /* Now there are threads.  Taking the lock again and trying it do not
+     block the owner.  */
+  flockfile (fp);
+  flockfile (fp);
+  if (ftrylockfile (fp) != 0)
+    {
+      puts ("ftrylockfile failed for the owner");
+      return 1;
+    }
+  funlockfile (fp);
+  funlockfile (fp);
+  funlockfile (fp);
+
+  for (i = 0; i < LINES; i++)
+    {
+      make_line (line, 'C', i);
+      fwrite (line, 1, 7, fp);
+    }
+  while (wait (NULL) > 0)
+    ;
+
+  rewind (fp);
+  while (fgets (line, sizeof line, fp) != NULL)
+    {
+      who = line[0] - 'A';
+      if (who < 0 || who > 2 || next[who] >= LINES)
+	{
+	  printf ("bad line: %s", line);
+	  return 1;
+	}
+      make_line (want, line[0], next[who]++);
+      if (strcmp (line, want) != 0)
+	{
+	  printf ("got %s, expected %s", line, want);
+	  return 1;
+	}
+    }
+  for (who = 0; who < 3; who++)
+    if (next[who] != LINES)
+      {
+	printf ("%d lines of %c\n", next[who], 'A' + who);
+	return 1;
+      }
+  fclose (fp);
+
+  /* Close GP while a thread waits for its lock.  */
+  flockfile (gp);
+  if (tfork (closed_waiter, 0) < 0)
+    {
+      perror ("tfork");
+      return 1;
+    }
+  for (i = 0; i < 100 && !waiting; i++)
+    usleep (10000);
+  usleep (10000);
+  funlockfile (gp);
+  fclose (gp);
+  while (wait (&status) > 0)
+    if (WEXITSTATUS (status) != 0)
+      {
+	puts ("ftrylockfile took a lock held by another thread");
+	return 1;
+      }
+
+  /* The new stream gets the lock of GP; if the waiter still held it,
+     this would never return.  */
+  fp = tmpfile ();
+  if (fp == NULL || fputc ('z', fp) == EOF || fclose (fp) != 0)
+    {
+      puts ("stream after a closed one not usable");
+      return 1;
+    }
+  return 0;
+}
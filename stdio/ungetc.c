@@ -17,11 +17,13 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include "lib.h"
 
 
-/* Push the character C back onto the input stream of STREAM.  */
-int
-ungetc (int c, FILE *stream)
+/* Push the character C back onto the input stream of STREAM, which
+   the caller has locked.  */
+static int
+unget (int c, FILE *stream)
 {
   if (!__validfp (stream) || !stream->__mode.__read)
     {
@@ -54,3 +56,15 @@ ungetc (int c, FILE *stream)
 
   return stream->__pushback;
 }
+
+/* Push the character C back onto the input stream of STREAM.  */
+int
+ungetc (int c, FILE *stream)
+{
+  int result;
+
+  __STDIO_LOCK (stream);
+  result = unget (c, stream);
+  __STDIO_UNLOCK (stream);
+  return result;
+}
@@ -23,24 +23,42 @@
 
 
 
-/* Enlarge STREAM's buffer.  */
+/* The output starts in a buffer of this size on the stack, so that a
+   short string needs only the one malloc for the result.  */
+#define INITIAL_SIZE 128
+
+/* Enlarge STREAM's buffer to twice its size.  The buffer on the stack
+   is the only one of INITIAL_SIZE bytes; it is copied, not freed.  */
 static void
 enlarge_buffer (FILE *stream, int c)
 {
   ptrdiff_t bufp_offset = stream->__bufp - stream->__buffer;
+  size_t size = 2 * stream->__bufsize;
   char *newbuf;
 
-  stream->__bufsize += 100;
-  newbuf = (char *) realloc ((void *) stream->__buffer, stream->__bufsize);
+  if (stream->__bufsize == INITIAL_SIZE)
+    {
+      newbuf = (char *) malloc (size);
+      if (newbuf != NULL)
+	memcpy (newbuf, stream->__buffer, bufp_offset);
+    }
+  else
+    {
+      newbuf = (char *) realloc ((void *) stream->__buffer, size);
+      if (newbuf == NULL)
+	free ((void *) stream->__buffer);
+    }
+
   if (newbuf == NULL)
     {
-      free ((void *) stream->__buffer);
       stream->__buffer = stream->__bufp
 	= stream->__put_limit = stream->__get_limit = NULL;
+      stream->__bufsize = 0;
       stream->__error = 1;
     }
   else
     {
+      stream->__bufsize = size;
       stream->__buffer = newbuf;
       stream->__bufp = stream->__buffer + bufp_offset;
       stream->__get_limit = stream->__put_limit;
@@ -57,15 +75,15 @@ vasprintf (char **string_ptr,
 	   const char *format,
 	   va_list args)
 {
+  char initial[INITIAL_SIZE];
   FILE f;
   int done;
+  size_t len;
 
   memset ((void *) &f, 0, sizeof (f));
   f.__magic = _IOMAGIC;
-  f.__bufsize = 100;
-  f.__buffer = (char *) malloc (f.__bufsize);
-  if (f.__buffer == NULL)
-    return -1;
+  f.__bufsize = INITIAL_SIZE;
+  f.__buffer = initial;
   f.__bufp = f.__buffer;
   f.__put_limit = f.__buffer + f.__bufsize;
   f.__mode.__write = 1;
@@ -74,11 +92,34 @@ vasprintf (char **string_ptr,
 
   done = vfprintf (&f, format, args);
   if (done < 0)
-    return done;
+    {
+      if (f.__buffer != initial)
+	free (f.__buffer);
+      return done;
+    }
 
-  *string_ptr = realloc (f.__buffer, (f.__bufp - f.__buffer) + 1);
-  if (*string_ptr == NULL)
-    *string_ptr = f.__buffer;
-  (*string_ptr)[f.__bufp - f.__buffer] = '\0';
+  len = f.__bufp - f.__buffer;
+  if (f.__buffer == initial)
+    {
+      *string_ptr = malloc (len + 1);
+      if (*string_ptr == NULL)
+	return -1;
+      memcpy (*string_ptr, initial, len);
+    }
+  else
+    {
+      *string_ptr = realloc (f.__buffer, len + 1);
+      if (*string_ptr == NULL)
+	{
+	  /* there is room for the NUL only if the buffer is not full */
+	  if (len == f.__bufsize)
+	    {
+	      free (f.__buffer);
+	      return -1;
+	    }
+	  *string_ptr = f.__buffer;
+	}
+    }
+  (*string_ptr)[len] = '\0';
   return done;
 }
@@ -38,6 +38,7 @@
 # include <string.h>
 #endif
 #include "lib.h"
+#include "atomicity.h"
 
 #if __GNUC_PREREQ(7, 0)
 # pragma GCC diagnostic ignored "-Wnonnull-compare"
@@ -77,7 +78,7 @@
   if (width > 0)							      \
     done += _IO_padn (s, (Padchar), width)
 # else
-#  define PUTC(C, F)	putc (C, F)
+#  define PUTC(C, F)	__putc (C, F)
 ssize_t __printf_pad __P ((FILE *, char pad, size_t n));
 # define PAD(Padchar) \
   do {									      \
@@ -162,7 +163,11 @@ ssize_t __wprintf_pad __P ((FILE *, wchar_t pad, size_t n));
 #else /* ! USE_IN_LIBIO */
 /* This code is for use in the GNU C library.  */
 # include <stdio.h>
-# define PUT(F, S, N)	fwrite (S, sizeof(CHAR_T), N, F)
+# ifdef COMPILE_WPRINTF
+#  define PUT(F, S, N)	fwrite_unlocked (S, sizeof(CHAR_T), N, F)
+# else
+#  define PUT(F, S, N)	printf_put (F, S, N)
+# endif
 # define ARGCHECK(S, Format)						      \
   do									      \
     {									      \
@@ -190,6 +195,25 @@ ssize_t __wprintf_pad __P ((FILE *, wchar_t pad, size_t n));
    have these prototypes.   */
 extern void __flockfile (FILE *);
 extern void __funlockfile (FILE *);
+
+# ifndef COMPILE_WPRINTF
+/* Write N characters at STR to S.  When they fit into the buffer, as
+   they almost always do for sprintf, snprintf and asprintf, they are
+   copied there like putc does for a single character; fwrite is only
+   needed to make room.  */
+static inline size_t
+printf_put (FILE *s, const char *str, size_t n)
+{
+  if (s->__bufp < s->__put_limit
+      && (size_t) (s->__put_limit - s->__bufp) >= n)
+    {
+      memcpy (s->__bufp, str, n);
+      s->__bufp += n;
+      return n;
+    }
+  return fwrite_unlocked (str, 1, n, s);
+}
+# endif
 #endif /* USE_IN_LIBIO */
 
 
@@ -260,6 +284,375 @@ static int printf_unknown (FILE *, const struct printf_info *,
 static CHAR_T *group_number (CHAR_T *, CHAR_T *, const char *, wchar_t)
      __THROW internal_function;
 
+#if !defined COMPILE_WPRINTF && !defined USE_IN_LIBIO
+/* Formats made of text and plain %d, %i, %u, %x, %X, %s, %c and %%,
+   optionally with an `l' for the numbers, do not need the general
+   machinery below.  Such a format is compiled once into a list of text
+   lengths and conversions, which is cached by the address of the
+   format; the output goes straight into the stream buffer.  */
+
+#define FAST_SPECS	8	/* most conversions in a compiled format */
+#define FAST_FMT_MAX	64	/* longest format that is compiled */
+#define FAST_CACHE	8	/* compiled formats remembered */
+#define FAST_LOCAL	256	/* buffer for an unbuffered stream */
+
+struct fast_spec
+{
+  unsigned char lit;		/* length of the text in front of it */
+  unsigned char skip;		/* length of the conversion itself */
+  char conv;			/* 'd', 'u', 'x', 'X', 's', 'c', '%', or
+				   0 for the text at the end */
+  char is_long;
+};
+
+struct fast_format
+{
+  unsigned char newline;	/* there is a newline in the text */
+  struct fast_spec spec[FAST_SPECS + 1];
+};
+
+/* The same address may hold a different format later, so an entry is
+   only used when the format still matches the copy kept in it.  Threads
+   from tfork share the cache without a lock: SEQ is odd while an entry
+   is written, and a reader that sees it change has read a torn entry
+   and compiles the format itself.  Only one thread writes an entry at a
+   time, the one that made SEQ odd; the others do not wait for it.  */
+struct fast_cache_entry
+{
+  volatile unsigned long seq;
+  const char *fmt;
+  int usable;			/* 0 if the general code is needed */
+  char copy[FAST_FMT_MAX + 1];
+  struct fast_format ff;
+};
+
+static struct fast_cache_entry fast_cache[FAST_CACHE];
+
+/* Keep the compiler from moving accesses of an entry across SEQ.  */
+#define fast_barrier() __asm__ __volatile__ ("" : : : "memory")
+
+/* Where the output of a fast format goes.  */
+struct fast_sink
+{
+  FILE *s;
+  char *p, *limit;
+  char *local;			/* buffer of an unbuffered stream */
+};
+
+/* Compile FORMAT, which is at most FAST_FMT_MAX characters long, into
+   FF.  Return 0 if the general code is needed for it.  */
+static int
+fast_compile (const char *format, struct fast_format *ff)
+{
+  const char *f = format, *lit = format;
+  struct fast_spec *sp = ff->spec;
+  char conv;
+  int is_long;
+
+  ff->newline = 0;
+  for (;;)
+    {
+      while (*f != '\0' && *f != '%')
+	if (*f++ == '\n')
+	  ff->newline = 1;
+      sp->lit = f - lit;
+      if (*f == '\0')
+	{
+	  sp->conv = 0;
+	  return 1;
+	}
+      if (sp == &ff->spec[FAST_SPECS])
+	return 0;
+
+      is_long = f[1] == 'l';
+      conv = f[1 + is_long];
+      switch (conv)
+	{
+	case 'i':
+	  conv = 'd';
+	  /* Fall through.  */
+	case 'd':
+	case 'u':
+	case 'x':
+	case 'X':
+	  break;
+	case 's':
+	case 'c':
+	case '%':
+	  /* %ls and %lc are wide characters */
+	  if (is_long)
+	    return 0;
+	  break;
+	default:
+	  return 0;
+	}
+      sp->conv = conv;
+      sp->is_long = is_long;
+      sp->skip = 2 + is_long;
+      f += sp->skip;
+      lit = f;
+      sp++;
+    }
+}
+
+/* Make SEQ of E, which was even, odd for writing the entry.  Return 0
+   if another thread was faster.  Without cas the cache is not written
+   once there are threads.  */
+static int
+fast_entry_claim (struct fast_cache_entry *e, unsigned long seq)
+{
+  if (!__libc_threads)
+    {
+      e->seq = seq + 1;
+      return 1;
+    }
+#if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__)
+  return compare_and_swap ((long *) &e->seq, (long) seq, (long) (seq + 1));
+#else
+  return 0;
+#endif
+}
+
+/* Copy the compiled form of FORMAT to FF.  Return 0 if FORMAT needs
+   the general code.  */
+static int
+fast_format_get (const char *format, struct fast_format *ff)
+{
+  struct fast_cache_entry *e
+    = &fast_cache[((unsigned long) format >> 1) % FAST_CACHE];
+  unsigned long seq = e->seq;
+  size_t len;
+  int usable;
+
+  fast_barrier ();
+  if ((seq & 1) == 0 && e->fmt == format && strcmp (e->copy, format) == 0)
+    {
+      usable = e->usable;
+      if (usable)
+	*ff = e->ff;
+      fast_barrier ();
+      if (e->seq == seq)
+	return usable;
+    }
+
+  for (len = 0; format[len] != '\0'; len++)
+    if (len == FAST_FMT_MAX)
+      return 0;
+  usable = fast_compile (format, ff);
+
+  /* Publish it, unless the entry is being written right now.  */
+  seq = e->seq;
+  if ((seq & 1) == 0 && fast_entry_claim (e, seq))
+    {
+      fast_barrier ();
+      e->fmt = format;
+      memcpy (e->copy, format, len + 1);
+      e->usable = usable;
+      if (usable)
+	e->ff = *ff;
+      fast_barrier ();
+      e->seq = seq + 2;
+    }
+  return usable;
+}
+
+/* The end of the room in the buffer of S.  An active line buffered
+   stream pretends to have none so that putc calls __flshfp for each
+   character; we fill its buffer and flush it at the end instead.  A
+   stream that is not writing yet has its put limit at the start of the
+   buffer, possibly below the read position.  */
+static char *
+fast_limit (FILE *s)
+{
+  if (s->__pushed_back)
+    return s->__bufp;
+  if (s->__linebuf_active
+      && s->__room_funcs.__output == __default_room_functions.__output)
+    return s->__buffer + s->__bufsize;
+  if (s->__put_limit < s->__bufp)
+    return s->__bufp;
+  return s->__put_limit;
+}
+
+/* Output N characters at STR that do not fit in OUT.  */
+static int
+fast_spill (struct fast_sink *out, const char *str, size_t n)
+{
+  FILE *s = out->s;
+
+  if (out->local == NULL)
+    {
+      s->__bufp = out->p;
+      if (fwrite_unlocked (str, 1, n, s) != n)
+	return -1;
+      out->p = s->__bufp;
+      out->limit = fast_limit (s);
+      return 0;
+    }
+
+  if (out->p != out->local)
+    {
+      size_t len = out->p - out->local;
+
+      if (fwrite_unlocked (out->local, 1, len, s) != len)
+	return -1;
+      out->p = out->local;
+    }
+  if (n <= FAST_LOCAL)
+    {
+      memcpy (out->p, str, n);
+      out->p += n;
+      return 0;
+    }
+  return fwrite_unlocked (str, 1, n, s) == n ? 0 : -1;
+}
+
+static inline int
+fast_put (struct fast_sink *out, const char *str, size_t n)
+{
+  if ((size_t) (out->limit - out->p) < n)
+    return fast_spill (out, str, n);
+  if (n < 16)
+    while (n-- > 0)
+      *out->p++ = *str++;
+  else
+    {
+      memcpy (out->p, str, n);
+      out->p += n;
+    }
+  return 0;
+}
+
+/* vfprintf for a format compiled into FF.  */
+static int
+fast_vfprintf (FILE *s, const char *format, const struct fast_format *ff,
+	       va_list ap)
+{
+  char local[FAST_LOCAL];
+  char digits[3 * sizeof (unsigned long)];
+  char *const digits_end = digits + sizeof digits;
+  const struct fast_spec *sp;
+  struct fast_sink out;
+  const char *str;
+  char *num;
+  unsigned long number;
+  long int value;
+  size_t len;
+  char ch;
+  int done = 0, newline = ff->newline;
+
+  __libc_cleanup_region_start ((void (*) (void *)) &__funlockfile, s);
+  __flockfile (s);
+
+  /* As in __flshfp: nothing goes to a stream with an error.  */
+  if (ferror (s))
+    {
+      done = -1;
+      goto unlock;
+    }
+
+  out.s = s;
+  if (UNBUFFERED_P (s))
+    {
+      out.local = out.p = local;
+      out.limit = local + sizeof local;
+    }
+  else
+    {
+      out.local = NULL;
+      out.p = s->__bufp;
+      out.limit = fast_limit (s);
+    }
+
+  for (sp = ff->spec;; sp++)
+    {
+      if (sp->lit != 0)
+	{
+	  if (fast_put (&out, format, sp->lit) != 0)
+	    goto fail;
+	  format += sp->lit;
+	  done += sp->lit;
+	}
+
+      switch (sp->conv)
+	{
+	case 0:
+	  goto flush;
+	case 'd':
+	  value = sp->is_long ? va_arg (ap, long int) : va_arg (ap, int);
+	  number = value < 0 ? -(unsigned long) value : (unsigned long) value;
+	  num = _itoa_word (number, digits_end, 10, 0);
+	  if (value < 0)
+	    *--num = '-';
+	  str = num;
+	  len = digits_end - str;
+	  break;
+	case 'u':
+	case 'x':
+	case 'X':
+	  number = (sp->is_long ? va_arg (ap, unsigned long int)
+		    : va_arg (ap, unsigned int));
+	  str = _itoa_word (number, digits_end, sp->conv == 'u' ? 10 : 16,
+			    sp->conv == 'X');
+	  len = digits_end - str;
+	  break;
+	case 's':
+	  str = va_arg (ap, const char *);
+	  if (str == NULL)
+	    str = null;
+	  len = strlen (str);
+	  if (s->__linebuf && memchr (str, '\n', len) != NULL)
+	    newline = 1;
+	  break;
+	case 'c':
+	  ch = (unsigned char) va_arg (ap, int); /* Promoted.  */
+	  if (ch == '\n')
+	    newline = 1;
+	  str = &ch;
+	  len = 1;
+	  break;
+	default:
+	  str = format + 1;	/* the second `%' */
+	  len = 1;
+	  break;
+	}
+
+      if ((unsigned int) INT_MAX - (unsigned int) done < len)
+	{
+	  __set_errno (EOVERFLOW);
+	  goto fail;
+	}
+      if (fast_put (&out, str, len) != 0)
+	goto fail;
+      done += len;
+      format += sp->skip;
+    }
+
+flush:
+  if (out.local != NULL)
+    {
+      if (fast_spill (&out, NULL, 0) != 0)
+	goto fail;
+    }
+  else
+    {
+      s->__bufp = out.p;
+      if (newline && s->__linebuf && fflush_unlocked (s) == EOF)
+	done = -1;
+    }
+  goto unlock;
+
+fail:
+  if (out.local == NULL)
+    s->__bufp = out.p;
+  done = -1;
+unlock:
+  __funlockfile (s);
+  __libc_cleanup_region_end (0);
+  return done;
+}
+#endif
+
 
 /* The function itself.  */
 int
@@ -1323,6 +1716,15 @@ vfprintf (FILE *s, const CHAR_T *format, va_list ap)
   /* Sanity check of arguments.  */
   ARGCHECK (s, format);
 
+#if !defined COMPILE_WPRINTF && !defined USE_IN_LIBIO
+  {
+    struct fast_format ff;
+
+    if (fast_format_get (format, &ff))
+      return fast_vfprintf (s, format, &ff, ap);
+  }
+#endif
+
   if (UNBUFFERED_P (s))
     /* Use a helper function which will allocate a local temporary buffer
        for the stream and then call us again.  */
@@ -2241,6 +2643,9 @@ buffered_vfprintf (register FILE *s, const CHAR_T *format, va_list args)
   char buf[BUFSIZ];
   int result;
 
+  /* No other thread may write into our buffer.  */
+  __flockfile (s);
+
   s->__bufp = s->__buffer = buf;
   s->__bufsize = sizeof buf;
   s->__put_limit = s->__buffer + s->__bufsize;
@@ -2249,11 +2654,13 @@ buffered_vfprintf (register FILE *s, const CHAR_T *format, va_list args)
   /* Now use buffer to print.  */
   result = vfprintf (s, format, args);
 
-  if (fflush (s) == EOF)
+  if (fflush_unlocked (s) == EOF)
     result = -1;
   s->__buffer = s->__bufp = s->__get_limit = s->__put_limit = NULL;
   s->__bufsize = 0;
 
+  __funlockfile (s);
+
   return result;
 }
 
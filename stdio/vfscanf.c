@@ -128,7 +128,7 @@
 #else
 # define ungetc(c, s)	((void) (c != EOF && --read_in), ungetc (c, s))
 # define inchar()	(c == EOF ? EOF					      \
-			 : ((c = getc (s)), (void) (c != EOF && ++read_in), c))
+			 : ((c = __getc (s)), (void) (c != EOF && ++read_in), c))
 # define encode_error()	do {						      \
 			  funlockfile (s);				      \
 			  __set_errno (EILSEQ);				      \
@@ -162,13 +162,8 @@
 	  return EOF;							      \
 	}								      \
     } while (0)
-#if 1
-      /* XXX For now !!! */
-# define flockfile(S) /* nothing */
-# define funlockfile(S) /* nothing */
-# define LOCK_STREAM(S)
-# define UNLOCK_STREAM(S)
-#else
+extern void __flockfile (FILE *);
+extern void __funlockfile (FILE *);
 # define LOCK_STREAM(S)							      \
   __libc_cleanup_region_start (&__funlockfile, (S));			      \
   __flockfile (S)
@@ -176,7 +171,6 @@
   __funlockfile (S);							      \
   __libc_cleanup_region_end (0)
 #endif
-#endif
 
 
 /* Read formatted input from S according to the format string
@@ -0,0 +1,234 @@
+/* Benchmark for the decimal to binary conversions: strtod, strtof,
+   atof and sscanf "%lf" are run over corpora of numbers as they show
+   up in real data, and the rate is printed in numbers and in bytes per
+   second.
+
+   Usage: bench-strtod [-n count] [file...]
+
+   The built in corpora are prices with two decimals, sensor readings
+   printed with "%.6f", coordinates printed with "%.17g" so that they
+   round trip, plain integers and numbers in exponent form.  Each file
+   named on the command line is another corpus with one number per
+   line.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* the numbers of the corpus, separated by NUL bytes */
+static char *text;
+static unsigned long textlen, textmax, count;
+
+/* the same pseudo random numbers everywhere */
+static unsigned long seed;
+
+static unsigned long
+rnd (unsigned long n)
+{
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  return ((seed >> 8) & 0xffffffUL) % n;
+}
+
+static void
+add (const char *s)
+{
+  unsigned long len = strlen (s) + 1;
+
+  if (textlen + len > textmax)
+    {
+      textmax = textmax ? 2 * textmax : 4096;
+      text = realloc (text, textmax);
+      if (text == NULL)
+	{
+	  fputs ("bench-strtod: out of memory\n", stderr);
+	  exit (1);
+	}
+    }
+  memcpy (text + textlen, s, len);
+  textlen += len;
+  count++;
+}
+
+static void
+make_prices (unsigned long n)
+{
+  char buf[32];
+
+  while (n-- > 0)
+    {
+      sprintf (buf, "%lu.%02lu", rnd (10000), rnd (100));
+      add (buf);
+    }
+}
+
+static void
+make_sensors (unsigned long n)
+{
+  char buf[32];
+
+  while (n-- > 0)
+    {
+      sprintf (buf, "%.6f", (double) rnd (2000000) / 1000.0 - 1000.0);
+      add (buf);
+    }
+}
+
+static void
+make_coords (unsigned long n)
+{
+  char buf[32];
+  double d;
+
+  while (n-- > 0)
+    {
+      d = ((double) rnd (0x1000000) * 0x1000000 + rnd (0x1000000))
+	  / 0x1000000 / 0x1000000;
+      sprintf (buf, "%.17g", d * 360.0 - 180.0);
+      add (buf);
+    }
+}
+
+static void
+make_integers (unsigned long n)
+{
+  char buf[32];
+
+  while (n-- > 0)
+    {
+      sprintf (buf, "%lu", rnd (0x1000000) >> rnd (24));
+      add (buf);
+    }
+}
+
+static void
+make_exponents (unsigned long n)
+{
+  char buf[32];
+
+  while (n-- > 0)
+    {
+      sprintf (buf, "%lu.%03lue%d", 1 + rnd (9), rnd (1000),
+	       (int) rnd (601) - 300);
+      add (buf);
+    }
+}
+
+static int
+load_file (const char *name)
+{
+  FILE *fp = fopen (name, "r");
+  char line[128];
+  char *p;
+
+  if (fp == NULL)
+    {
+      perror (name);
+      return -1;
+    }
+  while (fgets (line, sizeof line, fp) != NULL)
+    {
+      p = strchr (line, '\n');
+      if (p != NULL)
+	*p = '\0';
+      if (line[0] != '\0')
+	add (line);
+    }
+  fclose (fp);
+  return 0;
+}
+
+enum { STRTOD, STRTOF, ATOF, SSCANF };
+static const char *const names[] = { "strtod", "strtof", "atof", "sscanf" };
+
+/* the sum keeps the compiler from dropping the conversions */
+static double sum;
+
+static void
+run (int what)
+{
+  const char *p, *end = text + textlen;
+  double d;
+
+  for (p = text; p < end; p += strlen (p) + 1)
+    {
+      switch (what)
+	{
+	case STRTOD:
+	  d = strtod (p, NULL);
+	  break;
+	case STRTOF:
+	  d = strtof (p, NULL);
+	  break;
+	case ATOF:
+	  d = atof (p);
+	  break;
+	default:
+	  d = 0;
+	  sscanf (p, "%lf", &d);
+	  break;
+	}
+      sum += d;
+    }
+}
+
+static void
+bench (const char *name)
+{
+  clock_t start, used;
+  unsigned long rounds, i;
+  int what;
+  double secs;
+
+  for (what = STRTOD; what <= SSCANF; what++)
+    {
+      /* at least a quarter of a second for every function */
+      for (rounds = 1;; rounds *= 4)
+	{
+	  start = clock ();
+	  for (i = 0; i < rounds; i++)
+	    run (what);
+	  used = clock () - start;
+	  if (used >= CLOCKS_PER_SEC / 4)
+	    break;
+	}
+      secs = (double) used / CLOCKS_PER_SEC;
+      printf ("%-12s %-7s %8lu numbers %10.0f numbers/s %8.0f KB/s\n",
+	      name, names[what], count, count * rounds / secs,
+	      textlen * rounds / secs / 1024);
+    }
+  textlen = count = 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  unsigned long n = 4096;
+  int result = 0, i = 1;
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    {
+      n = strtoul (argv[2], NULL, 10);
+      i = 3;
+    }
+
+  seed = 1; make_prices (n); bench ("prices");
+  seed = 2; make_sensors (n); bench ("sensors");
+  seed = 3; make_coords (n); bench ("coords");
+  seed = 4; make_integers (n); bench ("integers");
+  seed = 5; make_exponents (n); bench ("exponents");
+
+  for (; i < argc; i++)
+    {
+      if (load_file (argv[i]) != 0)
+	{
+	  result = 1;
+	  continue;
+	}
+      if (count != 0)
+	bench (argv[i]);
+    }
+
+  free (text);
+  return result;
+}
@@ -62,4 +62,23 @@ extern const struct mp_power _fpioconst_pow10[LDBL_MAX_10_EXP_LOG + 1];
 #endif
 
 
+/* Every eighth power of ten from 10^-348 to 10^340, rounded to 64 bits:
+   10^k is about f * 2^e.  These are used by the fast paths of
+   __printf_fp and strtod, which do without MPN arithmetic when the
+   error of the rounded powers cannot change the result.  */
+struct fpio_cached_power
+  {
+    unsigned long long f;
+    short e;
+    short k;
+  };
+#define _FPIO_CACHED_FIRST_K	-348
+#define _FPIO_CACHED_STEP	8
+#define _FPIO_CACHED_COUNT	87
+extern const struct fpio_cached_power _fpioconst_cached_pow10[];
+
+/* The upper 64 bits of the product of A and B, rounded.  */
+extern unsigned long long __fpio_mul_hi64 (unsigned long long a,
+					   unsigned long long b);
+
 #endif	/* fpioconst.h */
@@ -24,16 +24,47 @@
 #include <memcopy.h>
 #include <errno.h>
 
-static void msort_with_tmp (void *b, size_t n, size_t s,
-			    __compar_fn_t cmp, char *t);
+extern void _quicksort __P ((void *const __base,
+			     size_t __nmemb, size_t __size,
+			     __compar_d_fn_t __compar, void *__arg));
+
+__typeof__(qsort_r) __qsort_r;
+
+/* Elements bigger than this are not moved while merging; an array of
+   pointers to them is sorted instead and the elements are put in
+   place at the end.  */
+#define INDIRECT_SIZE 32
+
+/* How the merge moves elements.  */
+enum merge_type
+  {
+    MERGE_4,		/* one aligned op_t */
+    MERGE_8,		/* two aligned op_t */
+    MERGE_WORDS,	/* a multiple of OPSIZ, aligned */
+    MERGE_INDIRECT,	/* pointers to the elements */
+    MERGE_BYTES
+  };
+
+struct msort_param
+{
+  size_t s;
+  enum merge_type var;
+  __compar_d_fn_t cmp;
+  void *arg;
+  char *t;
+};
+
+static void msort_with_tmp (const struct msort_param *p, void *b, size_t n);
 
 static void
-msort_with_tmp (void *b, size_t n, size_t s, __compar_fn_t cmp,
-		char *t)
+msort_with_tmp (const struct msort_param *p, void *b, size_t n)
 {
   char *tmp;
   char *b1, *b2;
   size_t n1, n2;
+  const size_t s = p->s;
+  __compar_d_fn_t cmp = p->cmp;
+  void *arg = p->arg;
 
   if (n <= 1)
     return;
@@ -43,78 +74,221 @@ msort_with_tmp (void *b, size_t n, size_t s, __compar_fn_t cmp,
   b1 = b;
   b2 = (char *) b + (n1 * s);
 
-  msort_with_tmp (b1, n1, s, cmp, t);
-  msort_with_tmp (b2, n2, s, cmp, t);
+  msort_with_tmp (p, b1, n1);
+  msort_with_tmp (p, b2, n2);
 
-  tmp = t;
+  tmp = p->t;
 
-  if (s == OPSIZ && (b1 - (char *) 0) % OPSIZ == 0)
-    /* We are operating on aligned words.  Use direct word stores.  */
-    while (n1 > 0 && n2 > 0)
-      {
-	if ((*cmp) (b1, b2) <= 0)
-	  {
-	    --n1;
-	    *((op_t *) tmp) = *((op_t *) b1);
-	    tmp += sizeof (op_t);
-	    b1 += sizeof (op_t);
-	  }
-	else
-	  {
-	    --n2;
-	    *((op_t *) tmp) = *((op_t *) b2);
-	    tmp += sizeof (op_t);
-	    b2 += sizeof (op_t);
-	  }
-      }
-  else
-    while (n1 > 0 && n2 > 0)
+  switch (p->var)
+    {
+    case MERGE_4:
+      while (n1 > 0 && n2 > 0)
+	{
+	  if ((*cmp) (b1, b2, arg) <= 0)
+	    {
+	      *(op_t *) tmp = *(op_t *) b1;
+	      b1 += sizeof (op_t);
+	      --n1;
+	    }
+	  else
+	    {
+	      *(op_t *) tmp = *(op_t *) b2;
+	      b2 += sizeof (op_t);
+	      --n2;
+	    }
+	  tmp += sizeof (op_t);
+	}
+      break;
+    case MERGE_8:
+      while (n1 > 0 && n2 > 0)
+	{
+	  if ((*cmp) (b1, b2, arg) <= 0)
+	    {
+	      ((op_t *) tmp)[0] = ((op_t *) b1)[0];
+	      ((op_t *) tmp)[1] = ((op_t *) b1)[1];
+	      b1 += 2 * sizeof (op_t);
+	      --n1;
+	    }
+	  else
+	    {
+	      ((op_t *) tmp)[0] = ((op_t *) b2)[0];
+	      ((op_t *) tmp)[1] = ((op_t *) b2)[1];
+	      b2 += 2 * sizeof (op_t);
+	      --n2;
+	    }
+	  tmp += 2 * sizeof (op_t);
+	}
+      break;
+    case MERGE_WORDS:
+      while (n1 > 0 && n2 > 0)
+	{
+	  op_t *src, *dst = (op_t *) tmp;
+	  size_t i = s / OPSIZ;
+
+	  if ((*cmp) (b1, b2, arg) <= 0)
+	    {
+	      src = (op_t *) b1;
+	      b1 += s;
+	      --n1;
+	    }
+	  else
+	    {
+	      src = (op_t *) b2;
+	      b2 += s;
+	      --n2;
+	    }
+	  do
+	    *dst++ = *src++;
+	  while (--i > 0);
+	  tmp = (char *) dst;
+	}
+      break;
+    case MERGE_INDIRECT:
+      while (n1 > 0 && n2 > 0)
+	{
+	  if ((*cmp) (*(const void **) b1, *(const void **) b2, arg) <= 0)
+	    {
+	      *(void **) tmp = *(void **) b1;
+	      b1 += sizeof (void *);
+	      --n1;
+	    }
+	  else
+	    {
+	      *(void **) tmp = *(void **) b2;
+	      b2 += sizeof (void *);
+	      --n2;
+	    }
+	  tmp += sizeof (void *);
+	}
+      break;
+    default:
+      while (n1 > 0 && n2 > 0)
+	{
+	  if ((*cmp) (b1, b2, arg) <= 0)
+	    {
+	      tmp = (char *) __mempcpy (tmp, b1, s);
+	      b1 += s;
+	      --n1;
+	    }
+	  else
+	    {
+	      tmp = (char *) __mempcpy (tmp, b2, s);
+	      b2 += s;
+	      --n2;
+	    }
+	}
+      break;
+    }
+  if (n1 > 0)
+    memcpy (tmp, b1, n1 * s);
+  memcpy (b, p->t, (n - n2) * s);
+}
+
+/* Sort the N elements of size S at B through an array of pointers to
+   them at P->T + N pointers, and then move every element straight to
+   its place, one permutation cycle after the other (Knuth vol. 3,
+   exercise 5.2-10).  Each element is moved once, plus one move per
+   cycle through the buffer after the pointers.  */
+static void
+msort_indirect (struct msort_param *p, char *b, size_t n)
+{
+  const size_t s = p->s;
+  char **tp = (char **) (p->t + n * sizeof (void *));
+  char *save = (char *) (tp + n);
+  char *ip, *jp, *kp;
+  size_t i, j, k;
+
+  for (i = 0, ip = b; i < n; i++, ip += s)
+    tp[i] = ip;
+
+  p->s = sizeof (void *);
+  p->var = MERGE_INDIRECT;
+  msort_with_tmp (p, tp, n);
+
+  /* tp[i] now points to the element that belongs at b + i * s.  */
+  for (i = 0, ip = b; i < n; i++, ip += s)
+    if ((kp = tp[i]) != ip)
       {
-	if ((*cmp) (b1, b2) <= 0)
-	  {
-	    tmp = (char *) __mempcpy (tmp, b1, s);
-	    b1 += s;
-	    --n1;
-	  }
-	else
+	j = i;
+	jp = ip;
+	memcpy (save, ip, s);
+	do
 	  {
-	    tmp = (char *) __mempcpy (tmp, b2, s);
-	    b2 += s;
-	    --n2;
+	    k = (kp - b) / s;
+	    tp[j] = jp;
+	    memcpy (jp, kp, s);
+	    j = k;
+	    jp = kp;
+	    kp = tp[k];
 	  }
+	while (kp != ip);
+	tp[j] = jp;
+	memcpy (jp, save, s);
       }
-  if (n1 > 0)
-    memcpy (tmp, b1, n1 * s);
-  memcpy (b, t, (n - n2) * s);
 }
 
 void
-qsort (void *b, size_t n, size_t s, __compar_fn_t cmp)
+__qsort_r (void *b, size_t n, size_t s, __compar_d_fn_t cmp, void *arg)
 {
-  const size_t size = n * s;
+  size_t size;
+  struct msort_param p;
+  char *tmp = NULL;
+  int save = errno;
+
+  if (n <= 1)
+    return;
+
+  /* Big elements are sorted through pointers; that needs the merge
+     buffer and the pointer array, and room to keep one element.  */
+  if (s > INDIRECT_SIZE)
+    size = 2 * n * sizeof (void *) + s;
+  else
+    size = n * s;
 
   if (size < 1024)
     /* The temporary array is small, so put it on the stack.  */
-    msort_with_tmp (b, n, s, cmp, __alloca (size));
+    p.t = __alloca (size);
   else
     {
       /* It's somewhat large, so malloc it.  */
-      int save = errno;
-      char *tmp = malloc (size);
+      tmp = malloc (size);
       if (tmp == NULL)
 	{
 	  /* Couldn't get space, so use the slower algorithm
 	     that doesn't need a temporary array.  */
-	  extern void _quicksort __P ((void *const __base,
-				       size_t __nmemb, size_t __size,
-				       __compar_fn_t __compar));
-	  _quicksort (b, n, s, cmp);
+	  _quicksort (b, n, s, cmp, arg);
+	  __set_errno (save);
+	  return;
 	}
+      p.t = tmp;
+    }
+
+  p.s = s;
+  p.cmp = cmp;
+  p.arg = arg;
+  if (s > INDIRECT_SIZE)
+    msort_indirect (&p, b, n);
+  else
+    {
+      if ((unsigned long) b % __alignof__ (op_t) != 0 || s % OPSIZ != 0)
+	p.var = MERGE_BYTES;
+      else if (s == OPSIZ)
+	p.var = MERGE_4;
+      else if (s == 2 * OPSIZ)
+	p.var = MERGE_8;
       else
-	{
-	  msort_with_tmp (b, n, s, cmp, tmp);
-	  free (tmp);
-	}
-      __set_errno (save);
+	p.var = MERGE_WORDS;
+      msort_with_tmp (&p, b, n);
     }
+
+  free (tmp);
+  __set_errno (save);
+}
+weak_alias (__qsort_r, qsort_r)
+
+void
+qsort (void *b, size_t n, size_t s, __compar_fn_t cmp)
+{
+  /* The comparison function just does not see the extra argument.  */
+  __qsort_r (b, n, s, (__compar_d_fn_t) cmp, NULL);
 }
@@ -20,48 +20,173 @@
 #include <string.h>
 
 extern void _quicksort __P ((void *const pbase, size_t total_elems,
-			     size_t size, __compar_fn_t cmp));
-
-/* Byte-wise swap two items of size SIZE. */
-#define SWAP(a, b, size)						      \
-  do									      \
-    {									      \
-      register size_t __size = (size);					      \
-      register char *__a = (a), *__b = (b);				      \
-      do								      \
-	{								      \
-	  char __tmp = *__a;						      \
-	  *__a++ = *__b;						      \
-	  *__b++ = __tmp;						      \
-	} while (--__size > 0);						      \
-    } while (0)
+			     size_t size, __compar_d_fn_t cmp, void *arg));
+
+/* Elements are moved as longs when their size and the array allow it;
+   how is decided once per call.  */
+typedef unsigned long __attribute__ ((__may_alias__)) word_t;
+
+enum swap_type
+  {
+    SWAP_BYTES,
+    SWAP_WORDS,		/* size is a multiple of sizeof (word_t) */
+    SWAP_4,
+    SWAP_8
+  };
+
+static inline enum swap_type
+get_swap_type (void *const pbase, size_t size)
+{
+  if ((unsigned long) pbase % __alignof__ (word_t) != 0
+      || size % sizeof (word_t) != 0)
+    return SWAP_BYTES;
+  if (size == sizeof (word_t))
+    return SWAP_4;
+  if (size == 2 * sizeof (word_t))
+    return SWAP_8;
+  return SWAP_WORDS;
+}
+
+/* Swap two items of size SIZE. */
+static inline void
+do_swap (void *a, void *b, size_t size, enum swap_type type)
+{
+  switch (type)
+    {
+    case SWAP_4:
+      {
+	word_t t = *(word_t *) a;
+	*(word_t *) a = *(word_t *) b;
+	*(word_t *) b = t;
+      }
+      break;
+    case SWAP_8:
+      {
+	word_t t0 = ((word_t *) a)[0], t1 = ((word_t *) a)[1];
+	((word_t *) a)[0] = ((word_t *) b)[0];
+	((word_t *) a)[1] = ((word_t *) b)[1];
+	((word_t *) b)[0] = t0;
+	((word_t *) b)[1] = t1;
+      }
+      break;
+    case SWAP_WORDS:
+      {
+	register word_t *__a = a, *__b = b;
+	do
+	  {
+	    word_t t = *__a;
+	    *__a++ = *__b;
+	    *__b++ = t;
+	  }
+	while ((size -= sizeof (word_t)) > 0);
+      }
+      break;
+    default:
+      {
+	register char *__a = a, *__b = b;
+	do
+	  {
+	    char t = *__a;
+	    *__a++ = *__b;
+	    *__b++ = t;
+	  }
+	while (--size > 0);
+      }
+      break;
+    }
+}
+
+/* Copy an item of size SIZE. */
+static inline void
+do_copy (void *dst, const void *src, size_t size, enum swap_type type)
+{
+  switch (type)
+    {
+    case SWAP_4:
+      *(word_t *) dst = *(const word_t *) src;
+      break;
+    case SWAP_8:
+      ((word_t *) dst)[0] = ((const word_t *) src)[0];
+      ((word_t *) dst)[1] = ((const word_t *) src)[1];
+      break;
+    default:
+      memcpy (dst, src, size);
+      break;
+    }
+}
+
+#define SWAP(a, b, size) do_swap ((a), (b), (size), type)
 
 /* Discontinue quicksort algorithm when partition gets below this size.
-   This particular magic number was chosen to work best on a Sun 4/260. */
-#define MAX_THRESH 4
+   On the 68000 a call of the comparison function costs much more than
+   moving a few elements, and 8 needs the fewest calls in total.  */
+#define MAX_THRESH 8
 
-/* Stack node declarations used to store unfulfilled partition obligations. */
+/* Stack node declarations used to store unfulfilled partition
+   obligations, with the number of partitioning steps the partition
+   may still take before it is sorted with heapsort instead.  */
 typedef struct
   {
     char *lo;
     char *hi;
+    size_t depth;
   } stack_node;
 
 /* The next 4 #defines implement a very fast in-line stack abstraction. */
 #define STACK_SIZE	(8 * sizeof(unsigned long int))
-#define PUSH(low, high)	((void) ((top->lo = (low)), (top->hi = (high)), ++top))
-#define	POP(low, high)	((void) (--top, (low = top->lo), (high = top->hi)))
+#define PUSH(low, high, d)	((void) ((top->lo = (low)), (top->hi = (high)), \
+					 (top->depth = (d)), ++top))
+#define	POP(low, high, d)	((void) (--top, (low = top->lo), (high = top->hi), \
+					 (d = top->depth)))
 #define	STACK_NOT_EMPTY	(stack < top)
 
 
+/* Sort the N items at BASE with heapsort; used for the partitions for
+   which quicksort keeps picking bad pivots.  */
+static void
+siftdown (char *base, size_t k, size_t n, size_t size,
+	  __compar_d_fn_t cmp, void *arg, enum swap_type type)
+{
+  size_t j;
+
+  while ((j = 2 * k + 1) < n)
+    {
+      if (j + 1 < n
+	  && (*cmp) ((void *) (base + j * size),
+		     (void *) (base + (j + 1) * size), arg) < 0)
+	j++;
+      if ((*cmp) ((void *) (base + k * size),
+		  (void *) (base + j * size), arg) >= 0)
+	break;
+      SWAP (base + k * size, base + j * size, size);
+      k = j;
+    }
+}
+
+static void
+heapsort_r (char *base, size_t n, size_t size,
+	    __compar_d_fn_t cmp, void *arg, enum swap_type type)
+{
+  size_t k;
+
+  for (k = n / 2; k-- > 0; )
+    siftdown (base, k, n, size, cmp, arg, type);
+  while (--n > 0)
+    {
+      SWAP (base, base + n * size, size);
+      siftdown (base, 0, n, size, cmp, arg, type);
+    }
+}
+
+
 /* Order size using quicksort.  This implementation incorporates
-   four optimizations discussed in Sedgewick:
+   five optimizations discussed in Sedgewick and Musser:
 
    1. Non-recursive, using an explicit stack of pointer that store the
       next array partition to sort.  To save time, this maximum amount
       of space required to store an array of MAX_INT is allocated on the
       stack.  Assuming a 32-bit integer, this needs only 32 *
-      sizeof(stack_node) == 136 bits.  Pretty cheap, actually.
+      sizeof(stack_node) == 384 bytes.  Pretty cheap, actually.
 
    2. Chose the pivot element using a median-of-three decision tree.
       This reduces the probability of selecting a bad pivot value and
@@ -75,12 +200,19 @@ typedef struct
    4. The larger of the two sub-partitions is always pushed onto the
       stack first, with the algorithm then concentrating on the
       smaller partition.  This *guarantees* no more than log (n)
-      stack size is needed (actually O(1) in this case)!  */
+      stack size is needed (actually O(1) in this case)!
+
+   5. A partition that is still there after 2 * log2 (TOTAL_ELEMS)
+      partitioning steps is sorted with heapsort (introsort), so the
+      worst case is O(n log n) even for inputs made to defeat the
+      median-of-three.  */
 
 void
-_quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cmp)
+_quicksort (void *const pbase, size_t total_elems, size_t size,
+	    __compar_d_fn_t cmp, void *arg)
 {
   register char *base_ptr = (char *) pbase;
+  const enum swap_type type = get_swap_type (pbase, size);
 
   /* Allocating SIZE bytes for a pivot buffer facilitates a better
      algorithm below since we can do comparisons directly on the pivot. */
@@ -98,6 +230,10 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
       /* Largest size needed for 32-bit int!!! */
       stack_node stack[STACK_SIZE];
       stack_node *top = stack + 1;
+      size_t depth = 0, n;
+
+      for (n = total_elems; n > 1; n >>= 1)
+	depth += 2;
 
       while (STACK_NOT_EMPTY)
         {
@@ -106,6 +242,14 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
 
 	  char *pivot = pivot_buffer;
 
+	  if (depth == 0)
+	    {
+	      heapsort_r (lo, (hi - lo) / size + 1, size, cmp, arg, type);
+	      POP (lo, hi, depth);
+	      continue;
+	    }
+	  depth--;
+
 	  /* Select median value from among LO, MID, and HI. Rearrange
 	     LO and HI so the three values are sorted. This lowers the
 	     probability of picking a pathological pivot value and
@@ -113,17 +257,16 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
 
 	  char *mid = lo + size * ((hi - lo) / size >> 1);
 
-	  if ((*cmp) ((void *) mid, (void *) lo) < 0)
+	  if ((*cmp) ((void *) mid, (void *) lo, arg) < 0)
 	    SWAP (mid, lo, size);
-	  if ((*cmp) ((void *) hi, (void *) mid) < 0)
+	  if ((*cmp) ((void *) hi, (void *) mid, arg) < 0)
 	    SWAP (mid, hi, size);
 	  else
 	    goto jump_over;
-	  if ((*cmp) ((void *) mid, (void *) lo) < 0)
+	  if ((*cmp) ((void *) mid, (void *) lo, arg) < 0)
 	    SWAP (mid, lo, size);
 	jump_over:;
-	  memcpy (pivot, mid, size);
-	  pivot = pivot_buffer;
+	  do_copy (pivot, mid, size, type);
 
 	  left_ptr  = lo + size;
 	  right_ptr = hi - size;
@@ -133,10 +276,10 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
 	     that this algorithm runs much faster than others. */
 	  do
 	    {
-	      while ((*cmp) ((void *) left_ptr, (void *) pivot) < 0)
+	      while ((*cmp) ((void *) left_ptr, (void *) pivot, arg) < 0)
 		left_ptr += size;
 
-	      while ((*cmp) ((void *) pivot, (void *) right_ptr) < 0)
+	      while ((*cmp) ((void *) pivot, (void *) right_ptr, arg) < 0)
 		right_ptr -= size;
 
 	      if (left_ptr < right_ptr)
@@ -163,7 +306,7 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
             {
               if ((size_t) (hi - left_ptr) <= max_thresh)
 		/* Ignore both small partitions. */
-                POP (lo, hi);
+                POP (lo, hi, depth);
               else
 		/* Ignore small left partition. */
                 lo = left_ptr;
@@ -174,13 +317,13 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
           else if ((right_ptr - lo) > (hi - left_ptr))
             {
 	      /* Push larger left partition indices. */
-              PUSH (lo, right_ptr);
+              PUSH (lo, right_ptr, depth);
               lo = left_ptr;
             }
           else
             {
 	      /* Push larger right partition indices. */
-              PUSH (left_ptr, hi);
+              PUSH (left_ptr, hi, depth);
               hi = right_ptr;
             }
         }
@@ -205,7 +348,7 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
        and the operation speeds up insertion sort's inner loop. */
 
     for (run_ptr = tmp_ptr + size; run_ptr <= thresh; run_ptr += size)
-      if ((*cmp) ((void *) run_ptr, (void *) tmp_ptr) < 0)
+      if ((*cmp) ((void *) run_ptr, (void *) tmp_ptr, arg) < 0)
         tmp_ptr = run_ptr;
 
     if (tmp_ptr != base_ptr)
@@ -217,24 +360,17 @@ _quicksort (void *const pbase, size_t total_elems, size_t size, __compar_fn_t cm
     while ((run_ptr += size) <= end_ptr)
       {
 	tmp_ptr = run_ptr - size;
-	while ((*cmp) ((void *) run_ptr, (void *) tmp_ptr) < 0)
+	while ((*cmp) ((void *) run_ptr, (void *) tmp_ptr, arg) < 0)
 	  tmp_ptr -= size;
 
 	tmp_ptr += size;
         if (tmp_ptr != run_ptr)
           {
-            char *trav;
-
-	    trav = run_ptr + size;
-	    while (--trav >= run_ptr)
-              {
-                char c = *trav;
-                char *hi, *lo;
-
-                for (hi = lo = trav; (lo -= size) >= tmp_ptr; hi = lo)
-                  *hi = *lo;
-                *hi = c;
-              }
+	    /* Move the element down in one go, with the pivot buffer
+	       holding it meanwhile.  */
+	    do_copy (pivot_buffer, run_ptr, size, type);
+	    memmove (tmp_ptr + size, tmp_ptr, run_ptr - tmp_ptr);
+	    do_copy (tmp_ptr, pivot_buffer, size, type);
           }
       }
   }
@@ -433,6 +433,141 @@ __mpn_lshift_1 (mp_limb_t *ptr, mp_size_t size, unsigned int count,
 }
 
 
+#if MANT_DIG <= 53
+/* Clinger's and Eisel and Lemire's fast path: a decimal with up to 19
+   significant digits is exact in 64 bits, and multiplying it by a
+   power of ten rounded to 64 bits gives the result with an error of a
+   few units in the last of the 64 bits.  Unless the bits below the
+   mantissa are that close to half a unit, the rounding is decided and
+   the MPN code is not needed.  Only normalized results are made here.
+   The floating point unit is not used at all, so the extended precision
+   of the 68881 cannot round twice.  */
+
+# define FAST_MAX_DIG	19
+/* the error is counted in eighths of a unit */
+# define FAST_ERRORSCALE	8
+
+static const unsigned long long _tens_in_llong[FAST_MAX_DIG + 1] =
+{
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+  100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/* Shift M up until its top bit is set and return the shift.  */
+static inline int
+fast_normalize (unsigned long long *m)
+{
+  int shift = 0;
+
+  if ((*m >> 32) == 0)
+    {
+      *m <<= 32;
+      shift += 32;
+    }
+  if ((*m >> 48) == 0)
+    {
+      *m <<= 16;
+      shift += 16;
+    }
+  if ((*m >> 56) == 0)
+    {
+      *m <<= 8;
+      shift += 8;
+    }
+  while ((*m >> 63) == 0)
+    {
+      *m <<= 1;
+      shift++;
+    }
+  return shift;
+}
+
+/* Store MANT * 10^EXP10 rounded to *RESULT and return nonzero, or
+   return zero if that cannot be done safely.  MANT is not zero.  */
+static int
+fast_strtof (unsigned long long mant, int exp10, int negative, FLOAT *result)
+{
+  const struct fpio_cached_power *c;
+  mp_limb_t retval[RETURN_LIMB_SIZE];
+  unsigned long long f, pow, halfway, extra;
+  long long errors = 0;
+  int e, i, adj, shift, extrabits = 64 - MANT_DIG;
+
+  if (exp10 < _FPIO_CACHED_FIRST_K
+      || exp10 >= _FPIO_CACHED_FIRST_K + _FPIO_CACHED_COUNT * _FPIO_CACHED_STEP)
+    return 0;
+  i = (exp10 - _FPIO_CACHED_FIRST_K) / _FPIO_CACHED_STEP;
+  adj = (exp10 - _FPIO_CACHED_FIRST_K) % _FPIO_CACHED_STEP;
+  c = &_fpioconst_cached_pow10[i];
+
+  /* First by 10^ADJ, exactly if the product fits.  */
+  f = mant;
+  if (mant < _tens_in_llong[FAST_MAX_DIG - adj])
+    {
+      f *= _tens_in_llong[adj];
+      e = -fast_normalize (&f);
+    }
+  else
+    {
+      e = -fast_normalize (&f);
+      pow = _tens_in_llong[adj];
+      shift = fast_normalize (&pow);
+      f = __fpio_mul_hi64 (f, pow);
+      e += 64 - shift;
+      errors += FAST_ERRORSCALE / 2;
+    }
+
+  /* Then by the cached power, which is off by half a unit, and the
+     product is rounded to half a unit once more.  */
+  f = __fpio_mul_hi64 (f, c->f);
+  e += c->e + 64;
+  if (errors > 0)
+    errors += 1;
+  errors += FAST_ERRORSCALE / 2 + FAST_ERRORSCALE / 2;
+
+  shift = fast_normalize (&f);
+  e -= shift;
+  errors <<= shift;
+
+  /* F * 2^E is the value; the leading bit is worth 2^(E + 63).  */
+  e += 63;
+  if (e < MIN_EXP - 1 || e > MAX_EXP - 1)
+    return 0;
+
+  halfway = 1ULL << (extrabits - 1);
+  extra = f & ((1ULL << extrabits) - 1);
+  /* ERRORS is in eighths of a unit, so compare in eighths too.  */
+  if ((long long) (halfway * FAST_ERRORSCALE) - errors
+	< (long long) (extra * FAST_ERRORSCALE)
+      && (long long) (extra * FAST_ERRORSCALE)
+	< (long long) (halfway * FAST_ERRORSCALE) + errors)
+    return 0;
+
+  f >>= extrabits;
+  if (extra > halfway)
+    {
+      f++;
+      if ((f >> MANT_DIG) != 0)
+	{
+	  f >>= 1;
+	  if (++e > MAX_EXP - 1)
+	    return 0;
+	}
+    }
+
+  retval[0] = (mp_limb_t) f;
+# if RETURN_LIMB_SIZE > 1
+  retval[1] = (mp_limb_t) (f >> BITS_PER_MP_LIMB);
+# endif
+  *result = MPN2FLOAT (retval, e, negative);
+  return 1;
+}
+#endif	/* MANT_DIG <= 53 */
+
+
 #define INTERNAL(x) INTERNAL1(x)
 #define INTERNAL1(x) __##x##_internal
 
@@ -895,6 +1030,26 @@ INTERNAL (STRTOF) (const STRING_TYPE *nptr, STRING_TYPE **endptr, int group LOCA
       return round_and_return (retval, exponent, negative, 0, 0, 0);
     }
 
+#if MANT_DIG <= 53
+  if (dig_no <= FAST_MAX_DIG)
+    {
+      unsigned long long mant = 0;
+      const STRING_TYPE *dp = startp;
+      FLOAT result;
+      int n;
+
+      /* As in str_to_mpn, the radix character is skipped.  */
+      for (n = dig_no; n > 0; n--)
+	{
+	  while (*dp < L_('0') || *dp > L_('9'))
+	    ++dp;
+	  mant = (mant << 3) + (mant << 1) + (*dp++ - L_('0'));
+	}
+      if (fast_strtof (mant, exponent - (dig_no - int_no), negative, &result))
+	return result;
+    }
+#endif
+
   /* Now we have the number of digits in total and the integer digits as well
      as the exponent and its sign.  We can decide whether the read digits are
      really integer digits or belong to the fractional part; i.e. we normalize
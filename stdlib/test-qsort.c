@@ -0,0 +1,151 @@
+/* Test qsort and qsort_r with several element sizes, including the
+   ones with specialised swaps, and make sure an input made to defeat
+   the median-of-three pivot does not take quadratic time.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct context
+{
+  size_t offset;		/* where the key is in an element */
+  int dir;			/* 1 ascending, -1 descending */
+  unsigned long calls;
+};
+
+static int
+compare_r (const void *a, const void *b, void *arg)
+{
+  struct context *ctx = arg;
+  int x, y;
+
+  memcpy (&x, (const char *) a + ctx->offset, sizeof x);
+  memcpy (&y, (const char *) b + ctx->offset, sizeof y);
+  ctx->calls++;
+  return ctx->dir * (x < y ? -1 : x > y);
+}
+
+static int
+compare_int (const void *a, const void *b)
+{
+  int x = *(const int *) a, y = *(const int *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* McIlroy's adversary: the values of the elements are only fixed
+   when the sort looks at them, always so that the pivot is bad.  */
+static int *val, gas, nsolid, candidate;
+static unsigned long adv_calls;
+
+static int
+compare_adv (const void *a, const void *b, void *arg)
+{
+  int x = *(const int *) a, y = *(const int *) b;
+
+  adv_calls++;
+  if (val[x] == gas && val[y] == gas)
+    {
+      if (x == candidate)
+	val[x] = nsolid++;
+      else
+	val[y] = nsolid++;
+    }
+  if (val[x] == gas)
+    candidate = x;
+  else if (val[y] == gas)
+    candidate = y;
+  return val[x] - val[y];
+}
+
+extern void _quicksort (void *, size_t, size_t, __compar_d_fn_t, void *);
+
+int
+main (void)
+{
+  static const size_t sizes[] = { 4, 5, 8, 12, 16, 36, 64, 100 };
+  struct context ctx;
+  size_t si, n, i, k, s;
+  int result = 0, pass, v, w;
+  char *a;
+  int *ptr;
+
+  srandom (1);
+  for (si = 0; si < sizeof sizes / sizeof sizes[0]; si++)
+    for (n = 1; n < 2000; n = 3 * n + 1)
+      for (pass = 0; pass < 3; pass++)
+	{
+	  s = sizes[si];
+	  a = malloc (n * s);
+	  for (i = 0; i < n; i++)
+	    {
+	      v = pass == 0 ? random () % 1000 : pass == 1 ? (int) i : 7;
+	      memset (a + i * s, (char) v, s);
+	      memcpy (a + i * s + s - sizeof v, &v, sizeof v);
+	    }
+	  ctx.offset = s - sizeof v;
+	  ctx.dir = pass == 1 ? -1 : 1;
+	  ctx.calls = 0;
+	  if (n & 1)
+	    qsort_r (a, n, s, compare_r, &ctx);
+	  else
+	    /* the fallback when msort cannot get memory */
+	    _quicksort (a, n, s, compare_r, &ctx);
+
+	  for (i = 0; i < n; i++)
+	    {
+	      memcpy (&v, a + i * s + ctx.offset, sizeof v);
+	      if (i > 0)
+		{
+		  memcpy (&w, a + (i - 1) * s + ctx.offset, sizeof w);
+		  if (ctx.dir * (w - v) > 0)
+		    break;
+		}
+	      for (k = 0; k < ctx.offset; k++)
+		if (a[i * s + k] != (char) v)
+		  break;
+	      if (k < ctx.offset)
+		break;
+	    }
+	  if (i < n || (n > 1 && ctx.calls == 0))
+	    {
+	      printf ("qsort_r flunked for size %lu, n %lu, pass %d\n",
+		      (unsigned long) s, (unsigned long) n, pass);
+	      result = 1;
+	    }
+	  free (a);
+	}
+
+  n = 10000;
+  ptr = malloc (n * sizeof (int));
+  val = malloc (n * sizeof (int));
+  gas = n;
+  for (i = 0; i < n; i++)
+    {
+      ptr[i] = i;
+      val[i] = gas;
+    }
+  _quicksort (ptr, n, sizeof (int), compare_adv, NULL);
+  /* n log2 n is about 133000; quadratic would be millions */
+  if (adv_calls > 1000000)
+    {
+      printf ("_quicksort took %lu comparisons for the adversary\n",
+	      adv_calls);
+      result = 1;
+    }
+
+  for (i = 0; i < n; i++)
+    ptr[i] = n - i;
+  qsort (ptr, n, sizeof (int), compare_int);
+  for (i = 0; i < n; i++)
+    if (ptr[i] != (int) i + 1)
+      {
+	puts ("qsort flunked");
+	result = 1;
+	break;
+      }
+
+  free (ptr);
+  free (val);
+  return result;
+}
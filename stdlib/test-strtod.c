@@ -38,6 +38,14 @@ static const struct ltest tests[] =
     { "0e-19", 0, '\0', 0 },
     { "4\00012", 4.0, '\0', 0 },
     { "5.9e-76", 5.9e-76, '\0', 0 },
+    { "0.1", 0.1, '\0', 0 },
+    { "9007199254740993", 9007199254740993.0, '\0', 0 },
+    { "9007199254740995", 9007199254740995.0, '\0', 0 },
+    { "1234567890123456789", 1234567890123456789.0, '\0', 0 },
+    { "123456.789e-5x", 123456.789e-5, 'x', 0 },
+    { "2.2250738585072014e-308", 2.2250738585072014e-308, '\0', 0 },
+    { "1.7976931348623157e308", 1.7976931348623157e308, '\0', 0 },
+    { "7.038531e-26", 7.038531e-26, '\0', 0 },
     { NULL, 0, '\0', 0 }
   };
 
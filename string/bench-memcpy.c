@@ -0,0 +1,144 @@
+/* Benchmark for memcpy, memmove and memset: sizes from 1 byte to 1 MB,
+   each one for every alignment of source and destination within a 16
+   bytes line.  For every size the mean rate over all alignments and
+   the rate of the slowest alignment are printed.
+
+   Usage: bench-memcpy [-m maxsize] [-t ticks]
+
+   -t is the least number of clock ticks spent on each size and
+   function (default CLOCKS_PER_SEC / 4 spread over the alignments).  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LINE 16
+
+static char *src, *dst;
+static unsigned long maxsize = 1024 * 1024L;
+static clock_t ticks = CLOCKS_PER_SEC / 4;
+
+enum { MEMCPY, MEMMOVE, MEMSET };
+static const char *const names[] = { "memcpy", "memmove", "memset" };
+
+/* Do the operation rounds times; memmove copies within one buffer
+   with the destination a line above the source, so it has to copy
+   downwards.  */
+static void
+run (int what, char *s, char *d, unsigned long size, unsigned long rounds)
+{
+  unsigned long i;
+
+  for (i = 0; i < rounds; i++)
+    switch (what)
+      {
+      case MEMCPY:
+	memcpy (d, s, size);
+	break;
+      case MEMMOVE:
+	memmove (s + LINE + (d - dst), s, size);
+	break;
+      case MEMSET:
+	memset (d, (int) i, size);
+	break;
+      }
+}
+
+/* bytes per second for one alignment */
+static double
+rate (int what, unsigned long size, int salign, int dalign)
+{
+  char *s = src + salign, *d = dst + dalign;
+  unsigned long rounds = 1;
+  clock_t start, used, budget;
+
+  budget = ticks / (LINE * LINE);
+  if (budget < 1)
+    budget = 1;
+
+  /* find a number of rounds that takes long enough to be measured */
+  for (;;)
+    {
+      start = clock ();
+      run (what, s, d, size, rounds);
+      used = clock () - start;
+      if (used >= budget)
+	break;
+      if (used == 0)
+	rounds *= 8;
+      else
+	rounds = rounds * (budget + used - 1) / used + 1;
+    }
+  return (double) size * rounds * CLOCKS_PER_SEC / used;
+}
+
+static int
+check (unsigned long size)
+{
+  unsigned long i;
+
+  for (i = 0; i < size; i++)
+    src[i] = (char) (i * 7 + 1);
+  memset (dst, 0, size + 2 * LINE);
+  memcpy (dst + 3, src + 5, size);
+  if (memcmp (dst + 3, src + 5, size) != 0 || dst[2] != 0
+      || dst[size + 3] != 0)
+    {
+      printf ("memcpy is broken for size %lu\n", size);
+      return 1;
+    }
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  unsigned long size;
+  int what, sa, da, i;
+  double r, sum, worst;
+
+  for (i = 1; i + 1 < argc; i += 2)
+    if (strcmp (argv[i], "-m") == 0)
+      maxsize = strtoul (argv[i + 1], NULL, 0);
+    else if (strcmp (argv[i], "-t") == 0)
+      ticks = strtol (argv[i + 1], NULL, 0);
+
+  /* the buffers are moved to the start of a line, and memmove needs
+     one more line */
+  src = malloc (maxsize + 4 * LINE);
+  dst = malloc (maxsize + 4 * LINE);
+  if (src == NULL || dst == NULL)
+    {
+      fputs ("bench-memcpy: out of memory\n", stderr);
+      return 1;
+    }
+  src += (LINE - ((unsigned long) src & (LINE - 1))) & (LINE - 1);
+  dst += (LINE - ((unsigned long) dst & (LINE - 1))) & (LINE - 1);
+
+  if (check (maxsize))
+    return 1;
+
+  printf ("%-8s %8s %10s %10s\n", "", "size", "mean KB/s", "worst KB/s");
+  for (what = MEMCPY; what <= MEMSET; what++)
+    for (size = 1; size <= maxsize; size *= 2)
+      {
+	sum = 0;
+	worst = -1;
+	for (sa = 0; sa < LINE; sa++)
+	  for (da = 0; da < LINE; da++)
+	    {
+	      if (what == MEMSET && sa != 0)
+		break;
+	      r = rate (what, size, sa, da);
+	      sum += r;
+	      if (worst < 0 || r < worst)
+		worst = r;
+	    }
+	printf ("%-8s %8lu %10.0f %10.0f\n", names[what], size,
+		sum / (what == MEMSET ? LINE : LINE * LINE) / 1024,
+		worst / 1024);
+      }
+
+  return 0;
+}
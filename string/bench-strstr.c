@@ -0,0 +1,129 @@
+/* Benchmark for strstr, memmem and strcasestr with inputs that are
+   the worst case for a naive search: a haystack of 'a's searched for
+   'a's followed by a 'b' or a 'b' followed by 'a's, a periodic needle
+   that almost matches, and for comparison a random text.
+
+   Usage: bench-strstr [-n haystack-length]  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static char *hay, *needle;
+static void *volatile sink;
+static size_t hlen = 256 * 1024L;
+
+static unsigned long seed = 1;
+
+static unsigned int
+rnd (unsigned int n)
+{
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  return ((seed >> 8) & 0xffffffUL) % n;
+}
+
+/* fill the haystack with copies of pat, and the needle with nlen bytes
+   of copies of pat, with first and last as its first and last byte
+   unless they are 0 */
+static void
+setup (const char *pat, size_t nlen, char first, char last)
+{
+  size_t i, l = strlen (pat);
+
+  for (i = 0; i < hlen; i++)
+    hay[i] = pat[i % l];
+  hay[hlen] = '\0';
+  for (i = 0; i < nlen; i++)
+    needle[i] = pat[i % l];
+  if (first)
+    needle[0] = first;
+  if (last)
+    needle[nlen - 1] = last;
+  needle[nlen] = '\0';
+}
+
+static void
+setup_random (size_t nlen)
+{
+  size_t i;
+
+  for (i = 0; i < hlen; i++)
+    hay[i] = 'a' + rnd (26);
+  hay[hlen] = '\0';
+  for (i = 0; i < nlen; i++)
+    needle[i] = 'a' + rnd (26);
+  needle[nlen] = '\0';
+}
+
+static void
+run (const char *name, size_t nlen)
+{
+  static const char *const fn[] = { "strstr", "memmem", "strcasestr" };
+  clock_t start, used;
+  unsigned long rounds, i;
+  int f;
+
+  printf ("%-10s %6lu", name, (unsigned long) nlen);
+  for (f = 0; f < 3; f++)
+    {
+      rounds = 0;
+      start = clock ();
+      do
+	{
+	  for (i = 0; i < 4; i++)
+	    switch (f)
+	      {
+	      case 0:
+		sink = strstr (hay, needle);
+		break;
+	      case 1:
+		sink = memmem (hay, hlen, needle, nlen);
+		break;
+	      case 2:
+		sink = strcasestr (hay, needle);
+		break;
+	      }
+	  rounds += 4;
+	  used = clock () - start;
+	}
+      while (used < CLOCKS_PER_SEC / 2);
+      printf (" %s %8.0f KB/s", fn[f],
+	      (double) hlen * rounds * CLOCKS_PER_SEC / used / 1024);
+    }
+  putchar ('\n');
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const size_t nlens[] = { 2, 8, 31, 32, 256, 4096 };
+  size_t i;
+
+  if (argc > 2 && strcmp (argv[1], "-n") == 0)
+    hlen = strtoul (argv[2], NULL, 0);
+
+  hay = malloc (hlen + 1);
+  needle = malloc (4096 + 1);
+  if (hay == NULL || needle == NULL)
+    {
+      fputs ("bench-strstr: out of memory\n", stderr);
+      return 1;
+    }
+
+  for (i = 0; i < sizeof nlens / sizeof nlens[0]; i++)
+    {
+      if (nlens[i] > hlen)
+	break;
+      setup ("a", nlens[i], 0, 'b');
+      run ("a...ab", nlens[i]);
+      setup ("a", nlens[i], 'b', 0);
+      run ("ba...a", nlens[i]);
+      setup ("ab", nlens[i], 0, 'c');
+      run ("abab...c", nlens[i]);
+      setup_random (nlens[i]);
+      run ("random", nlens[i]);
+    }
+
+  return 0;
+}
@@ -2,6 +2,7 @@
 
 #include <stddef.h>
 #include <string.h>
+#include "wordscan.h"
 
 /*
  * memchr - search for a byte
@@ -14,7 +15,22 @@ memchr(const void *s, int ucharwanted, size_t size)
 	register size_t n;
 
 	scan = (const char *) s;
-	for (n = size; n > 0; n--)
+	n = size;
+#ifdef WORD_AT_A_TIME
+	if (n >= 2 * WORDSIZE) {
+		register const word_t *wp;
+		register word_t mask = REPEAT_BYTE(ucharwanted);
+
+		for (; !WORD_ALIGNED(scan); scan++, n--)
+			if (*scan == (char) ucharwanted)
+				return((void *)scan);
+		for (wp = (const word_t *) scan; n >= WORDSIZE; wp++, n -= WORDSIZE)
+			if (HAS_ZERO(*wp ^ mask))
+				break;
+		scan = (const char *) wp;
+	}
+#endif
+	for (; n > 0; n--)
 		if (*scan == (char) ucharwanted)
 			return((void *)scan);
 		else
@@ -2,6 +2,7 @@
 
 #include <stddef.h>
 #include <string.h>
+#include "wordscan.h"
 
 /*
  * memcmp - compare bytes
@@ -25,7 +26,26 @@ memcmp(const void *s1, const void *s2, size_t size)
 
 	scan1 = (const char *) s1;
 	scan2 = (const char *) s2;
-	for (n = size; n > 0; n--)
+	n = size;
+#ifdef WORD_AT_A_TIME
+	if (n >= 2 * WORDSIZE) {
+		for (; !WORD_ALIGNED(scan1); n--)
+			if (*scan1 == *scan2) {
+				scan1++;
+				scan2++;
+			} else
+				return(UNSCHAR (*scan1) - UNSCHAR (*scan2));
+		/* scan2 may still be misaligned, which the 68020 and the
+		   ColdFire can cope with; we never read beyond size here */
+		while (n >= WORDSIZE
+		       && *(const word_t *) scan1 == *(const word_t *) scan2) {
+			scan1 += WORDSIZE;
+			scan2 += WORDSIZE;
+			n -= WORDSIZE;
+		}
+	}
+#endif
+	for (; n > 0; n--)
 		if (*scan1 == *scan2) {
 			scan1++;
 			scan2++;
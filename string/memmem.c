@@ -3,36 +3,38 @@
  * Copyright (C) 2000-2005 Erik Andersen <andersen@uclibc.org>
  *
  * Licensed under the LGPL v2.1, see the file COPYING.LIB in this tarball.
+ *
+ * The search is now the Two-Way algorithm from twoway.h.
  */
 
 #include <string.h>
 
+#define RETURN_TYPE void *
+#define AVAILABLE(h, h_l, j, n_l) ((j) <= (h_l) - (n_l))
+#include "twoway.h"
+
 void *memmem(const void *haystack, size_t haystacklen,
 		     const void *needle, size_t needlelen)
 {
-	register const char *ph;
-	register const char *pn;
-	const char *plast;
-	size_t n;
+	const unsigned char *ph;
+	const unsigned char *pn = (const unsigned char *) needle;
 
 	if (needlelen == 0) {
 		return (void *) haystack;
 	}
+	if (haystacklen < needlelen) {
+		return NULL;
+	}
 
-	if (haystacklen >= needlelen) {
-		ph = (const char *) haystack;
-		pn = (const char *) needle;
-		plast = ph + (haystacklen - needlelen);
-
-		do {
-			n = 0;
-			while (ph[n] == pn[n]) {
-				if (++n == needlelen) {
-					return (void *) ph;
-				}
-			}
-		} while (++ph <= plast);
+	/* skip to the first candidate quickly */
+	ph = memchr(haystack, pn[0], haystacklen - needlelen + 1);
+	if (ph == NULL || needlelen == 1) {
+		return (void *) ph;
 	}
+	haystacklen -= ph - (const unsigned char *) haystack;
 
-	return NULL;
+	if (needlelen < LONG_NEEDLE) {
+		return two_way_short(ph, haystacklen, pn, needlelen);
+	}
+	return two_way_long(ph, haystacklen, pn, needlelen);
 }
@@ -1,5 +1,6 @@
 #include <stddef.h>
 #include <string.h>
+#include "wordscan.h"
 
 /*
  * memrchr - search for a byte (backwards)
@@ -12,7 +13,26 @@ memrchr(const void *s, int ucharwanted, size_t size)
 	register size_t n;
 
 	scan = (const char *) (s + size - 1);
-	for (n = size; n > 0; n--)
+	n = size;
+#ifdef WORD_AT_A_TIME
+	if (n >= 2 * WORDSIZE) {
+		register const word_t *wp;
+		register word_t w, mask = REPEAT_BYTE(ucharwanted);
+
+		/* scan + 1 is the end of the part still to search */
+		for (; !WORD_ALIGNED(scan + 1); scan--, n--)
+			if (*scan == (char) ucharwanted)
+				return((void *)scan);
+		for (wp = (const word_t *) (scan + 1); n >= WORDSIZE; n -= WORDSIZE) {
+			w = wp[-1] ^ mask;
+			if (HAS_ZERO(w))
+				break;
+			wp--;
+		}
+		scan = (const char *) wp - 1;
+	}
+#endif
+	for (; n > 0; n--)
 		if (*scan == (char) ucharwanted)
 			return((void *)scan);
 		else
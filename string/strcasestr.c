@@ -11,35 +11,42 @@
 #include <string.h>
 #include <ctype.h>
 
+#define RETURN_TYPE char *
+#define AVAILABLE(h, h_l, j, n_l)					\
+	((j) + (n_l) <= (h_l)						\
+	 || ((h_l) += strnlen ((const char *) (h) + (h_l), (n_l) + 512),	\
+	     (j) + (n_l) <= (h_l)))
+#define CANON(c) toupper (c)
+#define CMP_FUNC(a, b, n) strncasecmp ((const char *) (a), (const char *) (b), n)
+#include "twoway.h"
+
 /* Similar to `strstr' but this function ignores the case of both strings.  */
 
 char*				/* Found string, or NULL if none.  */
 __strcasestr (const char* s, const char* wanted)
 {
-	register const char* scan;
-	register size_t len;
-	register char firstc;
-
-	if (!*s) {
-		if (*wanted)
-			return NULL;
-		else
-			return (char*) s;
-	} else if (!*wanted) {
+	const unsigned char *h = (const unsigned char *) s;
+	const unsigned char *n = (const unsigned char *) wanted;
+	size_t hl, nl;
+	int firstc;
+
+	if (!*wanted)
 		return (char*) s;
+
+	if (!n[1]) {
+		firstc = toupper (n[0]);
+		for (; *h != '\0'; h++)
+			if (toupper (*h) == firstc)
+				return (char*) h;
+		return NULL;
 	}
-	
-	/*
-	 * The odd placement of the two tests is so "" is findable.
-	 * Also, we inline the first char for speed.
-	 * The ++ on scan has been moved down for optimization.
-	 */
-	firstc = *wanted;
-	len = strlen (wanted);
-	for (scan = s; 
-	     toupper (*scan) != toupper (firstc) || strncasecmp(scan, wanted, len) != 0; )
-		if (*scan++ == '\0')
-			return NULL;
-	return (char*) scan;
+
+	nl = strlen (wanted);
+	hl = strnlen (s, nl + 512);
+	if (hl < nl)
+		return NULL;
+	if (nl < LONG_NEEDLE)
+		return two_way_short (h, hl, n, nl);
+	return two_way_long (h, hl, n, nl);
 }
 weak_alias (__strcasestr, strcasestr)
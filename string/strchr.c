@@ -2,6 +2,7 @@
 /* modified by ERS */
 /* Modified by Guido.  */
 #include <string.h>
+#include "wordscan.h"
 
 #undef index
 #undef strchr
@@ -17,6 +18,23 @@ __strchr(const char *s, int charwanted)
 {
 	register char c;
 
+#ifdef WORD_AT_A_TIME
+	for (; !WORD_ALIGNED(s); s++) {
+		if ((c = *s) == (char) charwanted)
+			return((char *)s);
+		if (c == 0)
+			return NULL;
+	}
+	{
+		register const word_t *wp = (const word_t *) s;
+		register word_t w, mask = REPEAT_BYTE(charwanted);
+
+		while (w = *wp, !HAS_ZERO_OR(w, mask))
+			wp++;
+		s = (const char *) wp;
+	}
+#endif
+
 	/*
 	 * The odd placement of the two tests is so NUL is findable.
 	 */
@@ -3,6 +3,7 @@
 /* Fixed by Guido:  Nobody ever thought of 8 bit characters???  */
 
 #include <string.h>
+#include "wordscan.h"
 #undef strcmp
 
 #if __GNUC_PREREQ(7, 0)
@@ -22,6 +23,23 @@ strcmp(const char *scan1, const char *scan2)
 		return scan2 ? -1 : 0;
 	if (!scan2) return 1;
 
+#ifdef WORD_AT_A_TIME
+	/* skip equal words as long as both strings can be read by words */
+	if ((((long) scan1 ^ (long) scan2) & WORDMASK) == 0) {
+		while (!WORD_ALIGNED(scan1) && *scan1 && *scan1 == *scan2)
+			scan1++, scan2++;
+		if (WORD_ALIGNED(scan1)) {
+			register const word_t *wp1 = (const word_t *) scan1;
+			register const word_t *wp2 = (const word_t *) scan2;
+
+			while (*wp1 == *wp2 && !HAS_ZERO(*wp1))
+				wp1++, wp2++;
+			scan1 = (const char *) wp1;
+			scan2 = (const char *) wp2;
+		}
+	}
+#endif
+
 	do {
 		c1 = (unsigned char) *scan1++; c2 = (unsigned char) *scan2++;
 	} while (c1 && c1 == c2);
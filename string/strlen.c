@@ -1,5 +1,6 @@
 /* from Henry Spencer's stringlib */
 #include <string.h>
+#include "wordscan.h"
 #undef strlen
 
 #if __GNUC_PREREQ(7, 0)
@@ -15,6 +16,18 @@ strlen(const char *scan)
 	register const char *start = scan+1;
 
 	if (!scan) return 0;
+#ifdef WORD_AT_A_TIME
+	while (!WORD_ALIGNED(scan))
+		if (*scan++ == '\0')
+			return (size_t)((long)scan - (long)start);
+	{
+		register const word_t *wp = (const word_t *) scan;
+
+		while (!HAS_ZERO(*wp))
+			wp++;
+		scan = (const char *) wp;
+	}
+#endif
 	while (*scan++ != '\0')
 		continue;
 	return (size_t)((long)scan - (long)start);
@@ -3,6 +3,7 @@
 /* Fixed by Guido (we need unsigned char!).  */
 
 #include <string.h>
+#include "wordscan.h"
 
 #undef strncmp
 
@@ -26,6 +27,23 @@ strncmp(const char *scan1, const char *scan2, size_t n)
 	}
 	if (!scan2) return 1;
 	count = n;
+#ifdef WORD_AT_A_TIME
+	if ((((long) scan1 ^ (long) scan2) & WORDMASK) == 0) {
+		while (count > 0 && !WORD_ALIGNED(scan1)
+		       && *scan1 && *scan1 == *scan2)
+			scan1++, scan2++, count--;
+		if (WORD_ALIGNED(scan1)) {
+			register const word_t *wp1 = (const word_t *) scan1;
+			register const word_t *wp2 = (const word_t *) scan2;
+
+			while (count >= (long) WORDSIZE
+			       && *wp1 == *wp2 && !HAS_ZERO(*wp1))
+				wp1++, wp2++, count -= WORDSIZE;
+			scan1 = (const char *) wp1;
+			scan2 = (const char *) wp2;
+		}
+	}
+#endif
 	do {
 		c1 = (unsigned char) *scan1++; c2 = (unsigned char) *scan2++;
 	} while (--count >= 0 && c1 && c1 == c2);
@@ -1,5 +1,6 @@
 /* from Henry Spencer's stringlib */
 #include <string.h>
+#include "wordscan.h"
 
 /*
  * strrchr - find last occurrence of a character in a string
@@ -12,6 +13,29 @@ strrchr(const char *s, int charwanted)
 	register const char *place;
 
 	place = NULL;
+#ifdef WORD_AT_A_TIME
+	if ((char) charwanted != '\0') {
+		register const word_t *wp, *last = NULL;
+		register word_t w, mask = REPEAT_BYTE(charwanted);
+
+		for (; !WORD_ALIGNED(s); s++) {
+			if ((c = *s) == 0)
+				return (char *)place;
+			if (c == (char) charwanted)
+				place = s;
+		}
+		/* remember the last word holding the char, then find it
+		   in there once the end of the string has been found */
+		for (wp = (const word_t *) s; w = *wp, !HAS_ZERO(w); wp++)
+			if (HAS_ZERO(w ^ mask))
+				last = wp;
+		if (last != NULL)
+			for (place = (const char *) last + WORDSIZE - 1;
+			     *place != (char) charwanted; place--)
+				continue;
+		s = (const char *) wp;
+	}
+#endif
 	while ((c = *s++) != 0)
 		if (c == (char) charwanted)
 			place = s - 1;
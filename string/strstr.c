@@ -1,9 +1,16 @@
-/* from Henry Spencer's stringlib */
-/* Bugfix by Guido: Handle empty strings correctly.  */
+/* Originally from Henry Spencer's stringlib; the search is now the
+   Two-Way algorithm from twoway.h.  */
 #include <string.h>
 
 #undef strstr
 
+#define RETURN_TYPE char *
+#define AVAILABLE(h, h_l, j, n_l)					\
+	((j) + (n_l) <= (h_l)						\
+	 || ((h_l) += strnlen ((const char *) (h) + (h_l), (n_l) + 512),	\
+	     (j) + (n_l) <= (h_l)))
+#include "twoway.h"
+
 /*
  * strstr - find first occurrence of wanted in s
  */
@@ -11,28 +18,22 @@
 char *				/* found string, or NULL if none */
 strstr(const char *s, const char *wanted)
 {
-	register const char *scan;
-	register size_t len;
-	register char firstc;
+	const unsigned char *h, *n = (const unsigned char *) wanted;
+	size_t hl, nl;
+
+	if (!*wanted)
+		return (char *) s;
+
+	/* skip to the first candidate quickly */
+	h = (const unsigned char *) strchr(s, *wanted);
+	if (h == NULL || !n[1])
+		return (char *) h;
 
-	if (!*s) {
-		if (*wanted)
-			return NULL;
-		else
-			return (char*) s;
-	} else if (!*wanted) {
-		return (char*) s;
-	}
-	
-	/*
-	 * The odd placement of the two tests is so "" is findable.
-	 * Also, we inline the first char for speed.
-	 * The ++ on scan has been moved down for optimization.
-	 */
-	firstc = *wanted;
-	len = strlen(wanted);
-	for (scan = s; *scan != firstc || strncmp(scan, wanted, len) != 0; )
-		if (*scan++ == '\0')
-			return(NULL);
-	return((char *)scan);
+	nl = strlen(wanted);
+	hl = strnlen((const char *) h, nl + 512);
+	if (hl < nl)
+		return NULL;
+	if (nl < LONG_NEEDLE)
+		return two_way_short(h, hl, n, nl);
+	return two_way_long(h, hl, n, nl);
 }
@@ -23,12 +23,15 @@
    test the real implementation.  */
 #undef __USE_STRING_INLINES
 
-#include <errno.h>
+/* The MiNTLib has no mmap(), so unlike the original version of this
+   test the strings are not put in front of an unmapped page; reading
+   past the end cannot be caught, but the results are still checked
+   for every alignment of the start and every length up to 64 at the
+   end of a buffer.  */
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <sys/mman.h>
-#include <sys/param.h>
 
 #ifndef MAX
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
@@ -37,148 +40,288 @@
 int
 main (int argc, char *argv[])
 {
-  int size = sysconf (_SC_PAGESIZE);
+  int size = 4096;
   char *adr, *dest;
   int result = 0;
+  int inner, middle, outer;
 
-  adr = (char *) mmap (NULL, 3 * size, PROT_READ|PROT_WRITE,
-		       MAP_PRIVATE|MAP_ANON, -1, 0);
-  dest = (char *) mmap (NULL, 3*size, PROT_READ|PROT_WRITE,
-			MAP_PRIVATE|MAP_ANON, -1, 0);
-  if (adr == MAP_FAILED || dest == MAP_FAILED)
+  adr = (char *) malloc (size);
+  dest = (char *) malloc (size);
+  if (adr == NULL || dest == NULL)
     {
-      if (errno == ENOSYS)
-        puts ("No test, mmap not available.");
-      else
-        {
-          printf ("mmap failed: %m");
-          result = 1;
-        }
+      puts ("No test, out of memory.");
+      return 0;
     }
-  else
-    {
-      int inner, middle, outer;
 
-      mprotect(adr, size, PROT_NONE);
-      mprotect(adr+2*size, size, PROT_NONE);
-      adr += size;
+  memset (adr, 'T', size);
 
-      mprotect(dest, size, PROT_NONE);
-      mprotect(dest+2*size, size, PROT_NONE);
-      dest += size;
+  /* strlen/strnlen test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (inner = MAX (outer, size - 64); inner < size; ++inner)
+	{
+	  adr[inner] = '\0';
+
+	  if (strlen (&adr[outer]) != (size_t) (inner - outer))
+	    {
+	      printf ("strlen flunked for outer = %d, inner = %d\n",
+		      outer, inner);
+	      result = 1;
+	    }
+	  if (strnlen (&adr[outer], inner - outer) != (size_t) (inner - outer)
+	      || strnlen (&adr[outer], size - outer) != (size_t) (inner - outer)
+	      || (inner > outer
+		  && strnlen (&adr[outer], inner - outer - 1)
+		     != (size_t) (inner - outer - 1)))
+	    {
+	      printf ("strnlen flunked for outer = %d, inner = %d\n",
+		      outer, inner);
+	      result = 1;
+	    }
 
-      memset (adr, 'T', size);
+	  adr[inner] = 'T';
+	}
+    }
 
-      /* strlen test */
-      for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
-        {
-          for (inner = MAX (outer, size - 64); inner < size; ++inner)
+  /* strchr/strchrnul test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (middle = MAX (outer, size - 64); middle < size; ++middle)
+	{
+	  for (inner = middle; inner < size; ++inner)
 	    {
+	      char *cp;
+	      adr[middle] = 'V';
 	      adr[inner] = '\0';
 
-	      if (strlen (&adr[outer]) != (size_t) (inner - outer))
+	      cp = strchr (&adr[outer], 'V');
+
+	      if ((inner == middle && cp != NULL)
+		  || (inner != middle
+		      && (cp - &adr[outer]) != middle - outer))
 		{
-		  printf ("strlen flunked for outer = %d, inner = %d\n",
-			  outer, inner);
+		  printf ("strchr flunked for outer = %d, middle = %d, "
+			  "inner = %d\n", outer, middle, inner);
 		  result = 1;
 		}
 
-	      adr[inner] = 'T';
-	    }
-        }
+	      cp = strchrnul (&adr[outer], 'V');
 
-      /* strchr test */
-      for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
-        {
-	  for (middle = MAX (outer, size - 64); middle < size; ++middle)
-	    {
-	      for (inner = middle; inner < size; ++inner)
+	      if (cp - &adr[outer] != middle - outer)
 		{
-		  char *cp;
-		  adr[middle] = 'V';
-		  adr[inner] = '\0';
-
-		  cp = strchr (&adr[outer], 'V');
-
-		  if ((inner == middle && cp != NULL)
-		      || (inner != middle
-			  && (cp - &adr[outer]) != middle - outer))
-		    {
-		      printf ("strchr flunked for outer = %d, middle = %d, "
-			      "inner = %d\n", outer, middle, inner);
-		      result = 1;
-		    }
-
-		  adr[inner] = 'T';
-		  adr[middle] = 'T';
+		  printf ("strchrnul flunked for outer = %d, middle = %d, "
+			  "inner = %d\n", outer, middle, inner);
+		  result = 1;
 		}
-	    }
-        }
 
-      /* strrchr test */
-      for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
-        {
-	  for (middle = MAX (outer, size - 64); middle < size; ++middle)
-	    {
-	      for (inner = middle; inner < size; ++inner)
+	      if (strchr (&adr[outer], '\0') != &adr[inner])
 		{
-		  char *cp;
-		  adr[middle] = 'V';
-		  adr[inner] = '\0';
-
-		  cp = strrchr (&adr[outer], 'V');
-
-		  if ((inner == middle && cp != NULL)
-		      || (inner != middle
-			  && (cp - &adr[outer]) != middle - outer))
-		    {
-		      printf ("strrchr flunked for outer = %d, middle = %d, "
-			      "inner = %d\n", outer, middle, inner);
-		      result = 1;
-		    }
-
-		  adr[inner] = 'T';
-		  adr[middle] = 'T';
+		  printf ("strchr (NUL) flunked for outer = %d, middle = %d, "
+			  "inner = %d\n", outer, middle, inner);
+		  result = 1;
 		}
+
+	      adr[inner] = 'T';
+	      adr[middle] = 'T';
 	    }
-        }
+	}
+    }
 
-      /* strcpy test */
-      for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
-        {
-          for (inner = MAX (outer, size - 64); inner < size; ++inner)
+  /* strrchr test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (middle = MAX (outer, size - 64); middle < size; ++middle)
+	{
+	  for (inner = middle; inner < size; ++inner)
 	    {
+	      char *cp;
+	      adr[middle] = 'V';
 	      adr[inner] = '\0';
 
-	      if (strcpy (dest, &adr[outer]) != dest
-		  || strlen (dest) != (size_t) (inner - outer))
+	      cp = strrchr (&adr[outer], 'V');
+
+	      if ((inner == middle && cp != NULL)
+		  || (inner != middle
+		      && (cp - &adr[outer]) != middle - outer))
+		{
+		  printf ("strrchr flunked for outer = %d, middle = %d, "
+			  "inner = %d\n", outer, middle, inner);
+		  result = 1;
+		}
+
+	      /* an earlier match must not win */
+	      adr[outer] = 'V';
+	      cp = strrchr (&adr[outer], 'V');
+	      if (inner != outer
+		  && cp - &adr[outer] != (inner == middle ? 0 : middle - outer))
 		{
-		  printf ("strcpy flunked for outer = %d, inner = %d\n",
-			  outer, inner);
+		  printf ("strrchr flunked for outer = %d, middle = %d, "
+			  "inner = %d (two matches)\n", outer, middle, inner);
 		  result = 1;
 		}
+	      adr[outer] = 'T';
 
 	      adr[inner] = 'T';
+	      adr[middle] = 'T';
 	    }
-        }
+	}
+    }
+
+  /* memchr/rawmemchr test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (middle = MAX (outer, size - 64); middle < size; ++middle)
+	{
+	  char *cp;
+	  adr[middle] = '\0';
 
-      /* stpcpy test */
-      for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
-        {
-          for (inner = MAX (outer, size - 64); inner < size; ++inner)
+	  cp = memchr (&adr[outer], '\0', size - outer);
+	  if (cp != &adr[middle])
 	    {
-	      adr[inner] = '\0';
+	      printf ("memchr flunked for outer = %d, middle = %d\n",
+		      outer, middle);
+	      result = 1;
+	    }
+
+	  cp = memchr (&adr[outer], '\0', middle - outer);
+	  if (cp != NULL)
+	    {
+	      printf ("memchr flunked for outer = %d, middle = %d (short)\n",
+		      outer, middle);
+	      result = 1;
+	    }
+
+	  cp = rawmemchr (&adr[outer], '\0');
+	  if (cp != &adr[middle])
+	    {
+	      printf ("rawmemchr flunked for outer = %d, middle = %d\n",
+		      outer, middle);
+	      result = 1;
+	    }
+
+	  adr[middle] = 'T';
+	}
+    }
+
+  /* memrchr test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (middle = MAX (outer, size - 64); middle < size; ++middle)
+	{
+	  char *cp;
+	  adr[middle] = 'V';
+
+	  cp = memrchr (&adr[outer], 'V', size - outer);
+	  if (cp != &adr[middle])
+	    {
+	      printf ("memrchr flunked for outer = %d, middle = %d\n",
+		      outer, middle);
+	      result = 1;
+	    }
+
+	  cp = memrchr (&adr[middle + 1], 'V', size - middle - 1);
+	  if (cp != NULL)
+	    {
+	      printf ("memrchr flunked for outer = %d, middle = %d (short)\n",
+		      outer, middle);
+	      result = 1;
+	    }
+
+	  adr[middle] = 'T';
+	}
+    }
+
+  /* strcmp/strncmp/memcmp test, for every relative alignment of the
+     two strings */
+  memset (dest, 'T', size);
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (middle = 0; middle < 8; ++middle)
+	{
+	  int len = size - 1 - outer;
+	  char *s1 = &adr[outer], *s2 = &dest[outer - middle];
 
-	      if ((stpcpy (dest, &adr[outer]) - dest) != inner - outer)
+	  s1[len] = '\0';
+	  s2[len] = '\0';
+
+	  for (inner = 0; inner <= len; ++inner)
+	    {
+	      if (strcmp (s1, s2) != 0 || strncmp (s1, s2, inner) != 0
+		  || memcmp (s1, s2, inner) != 0)
 		{
-		  printf ("stpcpy flunked for outer = %d, inner = %d\n",
-			  outer, inner);
+		  printf ("str(n)cmp/memcmp flunked for outer = %d, "
+			  "middle = %d, inner = %d (equal)\n",
+			  outer, middle, inner);
 		  result = 1;
 		}
 
-	      adr[inner] = 'T';
+	      if (inner == len)
+		break;
+
+	      s2[inner] = 'U';
+	      if (strcmp (s1, s2) >= 0 || strcmp (s2, s1) <= 0
+		  || strncmp (s1, s2, inner + 1) >= 0
+		  || strncmp (s1, s2, inner) != 0
+		  || memcmp (s1, s2, len) >= 0 || memcmp (s2, s1, len) <= 0
+		  || memcmp (s1, s2, inner) != 0)
+		{
+		  printf ("str(n)cmp/memcmp flunked for outer = %d, "
+			  "middle = %d, inner = %d\n", outer, middle, inner);
+		  result = 1;
+		}
+
+	      /* a byte with the top bit set sorts after 'T' */
+	      s2[inner] = '\xe4';
+	      if (strcmp (s1, s2) >= 0 || memcmp (s1, s2, len) >= 0)
+		{
+		  printf ("str(n)cmp/memcmp flunked for outer = %d, "
+			  "middle = %d, inner = %d (8 bit)\n",
+			  outer, middle, inner);
+		  result = 1;
+		}
+	      s2[inner] = 'T';
 	    }
-        }
+
+	  s1[len] = 'T';
+	  s2[len] = 'T';
+	}
+    }
+
+  /* strcpy test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (inner = MAX (outer, size - 64); inner < size; ++inner)
+	{
+	  adr[inner] = '\0';
+
+	  if (strcpy (dest, &adr[outer]) != dest
+	      || strlen (dest) != (size_t) (inner - outer))
+	    {
+	      printf ("strcpy flunked for outer = %d, inner = %d\n",
+		      outer, inner);
+	      result = 1;
+	    }
+
+	  adr[inner] = 'T';
+	}
+    }
+
+  /* stpcpy test */
+  for (outer = size - 1; outer >= MAX (0, size - 128); --outer)
+    {
+      for (inner = MAX (outer, size - 64); inner < size; ++inner)
+	{
+	  adr[inner] = '\0';
+
+	  if ((stpcpy (dest, &adr[outer]) - dest) != inner - outer)
+	    {
+	      printf ("stpcpy flunked for outer = %d, inner = %d\n",
+		      outer, inner);
+	      result = 1;
+	    }
+
+	  adr[inner] = 'T';
+	}
     }
 
   return result;
@@ -0,0 +1,93 @@
+/* Check strstr, memmem and strcasestr against a naive search, for
+   random haystacks and needles over small alphabets (which makes for
+   many partial matches and periodic needles) and for needles both
+   shorter and longer than the shift table threshold.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static unsigned long seed = 1;
+
+static unsigned int
+rnd (unsigned int n)
+{
+  seed = (seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+  return ((seed >> 8) & 0xffffffUL) % n;
+}
+
+static const char *
+naive (const char *h, size_t hl, const char *n, size_t nl, int icase)
+{
+  size_t i, k;
+
+  for (i = 0; i + nl <= hl; i++)
+    {
+      for (k = 0; k < nl; k++)
+	if (icase ? toupper ((unsigned char) h[i + k])
+		    != toupper ((unsigned char) n[k])
+		  : h[i + k] != n[k])
+	  break;
+      if (k == nl)
+	return h + i;
+    }
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const char alpha[] = "abAB";
+  static char h[600], n[80];
+  size_t hl, nl, i;
+  int round, result = 0, abc;
+  const char *want, *got;
+
+  for (round = 0; round < 20000; round++)
+    {
+      abc = 1 + rnd (4);
+      hl = rnd (round < 10000 ? 40 : sizeof h - 1);
+      nl = 1 + rnd (round & 1 ? 8 : sizeof n - 1);
+      for (i = 0; i < hl; i++)
+	h[i] = alpha[rnd (abc)];
+      h[hl] = '\0';
+      for (i = 0; i < nl; i++)
+	n[i] = alpha[rnd (abc)];
+      n[nl] = '\0';
+      /* make a match likely */
+      if (nl <= hl && rnd (2))
+	memcpy (h + rnd (hl - nl + 1), n, nl);
+
+      want = naive (h, hl, n, nl, 0);
+      got = strstr (h, n);
+      if (got != want)
+	{
+	  printf ("strstr (\"%s\", \"%s\") flunked\n", h, n);
+	  result = 1;
+	}
+      got = memmem (h, hl, n, nl);
+      if (got != want)
+	{
+	  printf ("memmem (\"%s\", \"%s\") flunked\n", h, n);
+	  result = 1;
+	}
+      want = naive (h, hl, n, nl, 1);
+      got = strcasestr (h, n);
+      if (got != want)
+	{
+	  printf ("strcasestr (\"%s\", \"%s\") flunked\n", h, n);
+	  result = 1;
+	}
+    }
+
+  if (strstr ("", "") == NULL || strstr ("abc", "") == NULL
+      || strstr ("", "a") != NULL || memmem ("abc", 3, "", 0) == NULL
+      || memmem ("abc", 3, "c\0", 2) != NULL)
+    {
+      puts ("empty string cases flunked");
+      result = 1;
+    }
+
+  return result;
+}
@@ -0,0 +1,187 @@
+/*  twoway.h -- MiNTLib.
+
+    Crochemore-Perrin Two-Way string matching, shared by strstr,
+    strcasestr and memmem.
+
+    This file is part of the MiNTLib project, and may only be used
+    modified and distributed under the terms of the MiNTLib project
+    license, COPYMINT.  By continuing to use, modify, or distribute
+    this file you indicate that you have read the license and
+    understand and accept it fully.
+*/
+
+/* The search takes time linear in the length of the haystack and
+   needs no memory besides a shift table on the stack for long needles.
+
+   Define before including this file:
+
+   RETURN_TYPE	the type returned by two_way_short and two_way_long
+   AVAILABLE(h, h_l, j, n_l)
+		nonzero if the haystack h holds at least j + n_l bytes;
+		h_l is the number of bytes known to be there and may
+		be increased
+   CANON(c)	the unsigned char c as it is to be compared (optional)
+   CMP_FUNC(a, b, n)
+		compare n bytes of a and b after CANON, like memcmp
+		(optional)
+
+   The needle must be at least two bytes long.  */
+
+#include <stddef.h>
+#include <string.h>
+
+#ifndef CANON
+# define CANON(c) (c)
+#endif
+#ifndef CMP_FUNC
+# define CMP_FUNC memcmp
+#endif
+
+/* needles at least this long get a shift table */
+#define LONG_NEEDLE 32
+
+#ifndef MAX
+# define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+/* Split the needle n of length l into two halves n[0..ms] and
+   n[ms+1..l-1] so that the local period at the split is the period of
+   the needle, which is stored in *period.  ms is -1 if the left half
+   is empty.  */
+static size_t
+critical_factorization (const unsigned char *n, size_t l, size_t *period)
+{
+	size_t ip, jp, k, p, ms, p0;
+	unsigned char a, b;
+
+	/* maximal suffix for < */
+	ip = -1; jp = 0; k = p = 1;
+	while (jp + k < l) {
+		a = CANON(n[ip + k]);
+		b = CANON(n[jp + k]);
+		if (a == b) {
+			if (k == p) {
+				jp += p;
+				k = 1;
+			} else
+				k++;
+		} else if (a > b) {
+			jp += k;
+			k = 1;
+			p = jp - ip;
+		} else {
+			ip = jp++;
+			k = p = 1;
+		}
+	}
+	ms = ip;
+	p0 = p;
+
+	/* and for >; the longer of the two suffixes wins */
+	ip = -1; jp = 0; k = p = 1;
+	while (jp + k < l) {
+		a = CANON(n[ip + k]);
+		b = CANON(n[jp + k]);
+		if (a == b) {
+			if (k == p) {
+				jp += p;
+				k = 1;
+			} else
+				k++;
+		} else if (a < b) {
+			jp += k;
+			k = 1;
+			p = jp - ip;
+		} else {
+			ip = jp++;
+			k = p = 1;
+		}
+	}
+	if (ip + 1 > ms + 1)
+		ms = ip;
+	else
+		p = p0;
+
+	*period = p;
+	return ms;
+}
+
+/* The search proper.  With a shift table the last byte of the window
+   is looked at first, and the window skips ahead by the distance of
+   that byte from the end of the needle.  */
+static inline RETURN_TYPE
+two_way_search (const unsigned char *h, size_t h_l,
+		const unsigned char *n, size_t l, const size_t *shift)
+{
+	size_t ms, p, mem, mem0, j, k;
+
+	ms = critical_factorization (n, l, &p);
+
+	/* If the left half occurs again one period later the needle
+	   is periodic, and after a shift by the period the bytes
+	   before mem are known to match.  Otherwise no two matches
+	   overlap by more than half the needle.  */
+	if (CMP_FUNC (n, n + p, ms + 1) == 0)
+		mem0 = l - p;
+	else {
+		mem0 = 0;
+		p = MAX(ms, l - ms - 1) + 1;
+	}
+
+	mem = 0;
+	j = 0;
+	while (AVAILABLE(h, h_l, j, l)) {
+		if (shift != NULL) {
+			k = shift[CANON(h[j + l - 1])];
+			if (k != 0) {
+				if (k < mem)
+					k = mem;
+				j += k;
+				mem = 0;
+				continue;
+			}
+		}
+
+		/* compare the right half */
+		for (k = MAX(ms + 1, mem);
+		     k < l && CANON(n[k]) == CANON(h[j + k]); k++)
+			continue;
+		if (k < l) {
+			j += k - ms;
+			mem = 0;
+			continue;
+		}
+
+		/* compare the left half */
+		for (k = ms + 1; k > mem && CANON(n[k - 1]) == CANON(h[j + k - 1]); k--)
+			continue;
+		if (k <= mem)
+			return (RETURN_TYPE) (h + j);
+		j += p;
+		mem = mem0;
+	}
+	return NULL;
+}
+
+static RETURN_TYPE
+two_way_short (const unsigned char *h, size_t h_l,
+	       const unsigned char *n, size_t l)
+{
+	return two_way_search (h, h_l, n, l, NULL);
+}
+
+static RETURN_TYPE
+two_way_long (const unsigned char *h, size_t h_l,
+	      const unsigned char *n, size_t l)
+{
+	size_t shift[256];
+	size_t i;
+
+	/* distance of the last occurrence of each byte from the end */
+	for (i = 0; i < 256; i++)
+		shift[i] = l;
+	for (i = 0; i < l; i++)
+		shift[CANON(n[i])] = l - 1 - i;
+
+	return two_way_search (h, h_l, n, l, shift);
+}
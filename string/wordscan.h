@@ -0,0 +1,47 @@
+/*  wordscan.h -- MiNTLib.
+
+    Helpers for the string functions that look at four bytes at a time.
+
+    This file is part of the MiNTLib project, and may only be used
+    modified and distributed under the terms of the MiNTLib project
+    license, COPYMINT.  By continuing to use, modify, or distribute
+    this file you indicate that you have read the license and
+    understand and accept it fully.
+*/
+
+#ifndef _WORDSCAN_H
+#define _WORDSCAN_H 1
+
+/* With its 16 bit bus the 68000 gains little from longword loads, so
+   only the 68020+ and ColdFire flavours use the word loops; the byte
+   loops following them in each function then only see the head and
+   the tail of the string.  */
+#if defined(__mc68020__) || defined(__mc68030__) || defined(__mc68040__) || defined(__mc68060__) || defined(__mcoldfire__)
+# define WORD_AT_A_TIME 1
+#endif
+
+typedef unsigned long __attribute__ ((__may_alias__)) word_t;
+
+#define WORDSIZE	sizeof (word_t)
+#define WORDMASK	(WORDSIZE - 1)
+#define WORD_ALIGNED(p)	(((unsigned long) (p) & WORDMASK) == 0)
+
+#define ONES		0x01010101UL
+#define HIGHS		0x80808080UL
+
+/* c in every byte of a word */
+#define REPEAT_BYTE(c)	((word_t) (unsigned char) (c) * ONES)
+
+/* Nonzero if one of the bytes of w is zero.  This has no false
+   positives, but the bits set in the result do not tell which byte
+   it was (a borrow may also flag the byte in front of the zero one on
+   a big endian machine), so callers finish with a byte loop.  */
+#define HAS_ZERO(w)	(((w) - ONES) & ~(w) & HIGHS)
+
+/* Nonzero if one of the bytes of w is zero or equal to the byte that
+   is repeated in mask.  */
+#define HAS_ZERO_OR(w, mask) \
+	(((((w) - ONES) & ~(w)) | ((((w) ^ (mask)) - ONES) & ~((w) ^ (mask)))) \
+	 & HIGHS)
+
+#endif /* _WORDSCAN_H */